@@ -209,10 +209,109 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 
 //==============================================================================
 
+void SpectrumBallistics::prepare(int maxNumBins)
+{
+    held.resize((size_t)maxNumBins, 0.f);
+    primed = false;
+}
+
+void SpectrumBallistics::setMode(AnalyzerMode newMode, float decayDBPerFrame)
+{
+    if (newMode != mode)
+    {
+        mode = newMode;
+        primed = false;
+    }
+
+    decayGain = juce::Decibels::decibelsToGain(-decayDBPerFrame);
+}
+
+void SpectrumBallistics::process(float* magnitudes, int numBins)
+{
+    using FVO = juce::FloatVectorOperations;
+
+    if (mode == AnalyzerMode::Realtime)
+        return;
+
+    if (!primed)
+    {
+        FVO::copy(held.data(), magnitudes, numBins);
+        primed = true;
+        return;
+    }
+
+    switch (mode)
+    {
+    case AnalyzerMode::Average:
+        //one pole smoother whose release matches the peak decay
+        FVO::multiply(held.data(), decayGain, numBins);
+        FVO::addWithMultiply(held.data(), magnitudes, 1.f - decayGain, numBins);
+        break;
+    case AnalyzerMode::PeakHold:
+        FVO::multiply(held.data(), decayGain, numBins);
+        FVO::max(held.data(), held.data(), magnitudes, numBins);
+        break;
+    case AnalyzerMode::InfiniteMax:
+        FVO::max(held.data(), held.data(), magnitudes, numBins);
+        break;
+    case AnalyzerMode::Realtime:
+        break;
+    }
+
+    FVO::copy(magnitudes, held.data(), numBins);
+}
+
+void zeroNonFiniteMagnitudes(float* data, int numValues)
+{
+    for (int i = 0; i < numValues; ++i)
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, data + i, sizeof(bits));
+
+        //NaN and inf have an all-ones exponent, the mask clears them without a branch
+        const auto isFinite = (bits & 0x7f800000) != 0x7f800000;
+        bits &= 0u - juce::uint32(isFinite);
+        std::memcpy(data + i, &bits, sizeof(bits));
+    }
+}
+
+void magnitudesToDecibels(float* data, int numValues, float minusInfinityDb)
+{
+    //flooring first also squashes zeros and denormals, so the log below never sees them
+    juce::FloatVectorOperations::max(data, data, juce::Decibels::decibelsToGain(minusInfinityDb), numValues);
+
+    //20 log10(x) = 20 log10(2) * (exponent + log2(mantissa)), with ln(mantissa) = 2 atanh((m - 1) / (m + 1))
+    //as a short odd series. good to about 1e-4 dB, which is far below a pixel
+    constexpr float dBPerOctave = 6.0205999f;
+    constexpr float dBPerNeper = 8.6858896f;
+
+    for (int i = 0; i < numValues; ++i)
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, data + i, sizeof(bits));
+
+        //NaN and inf have an all-ones exponent and may come through the max above, they are drawn at the floor
+        const auto isFinite = (bits & 0x7f800000) != 0x7f800000;
+
+        const auto exponent = float(int((bits >> 23) & 0xff) - 127);
+        bits = (bits & 0x007fffff) | 0x3f800000;
+
+        float mantissa;
+        std::memcpy(&mantissa, &bits, sizeof(mantissa));
+
+        const auto t = (mantissa - 1.f) / (mantissa + 1.f);
+        const auto t2 = t * t;
+        const auto lnMantissa = 2.f * t * (1.f + t2 * (1.f / 3.f + t2 * (1.f / 5.f + t2 * (1.f / 7.f))));
+
+        data[i] = isFinite ? exponent * dBPerOctave + lnMantissa * dBPerNeper : minusInfinityDb;
+    }
+}
+
+//==============================================================================
+
 ResponseCurveComponent::ResponseCurveComponent(EQAudioProcessor& p) :
     audioProcessor(p),
-    leftPathProducer(audioProcessor.leftChannelFifo), 
-    rightPathProducer(audioProcessor.rightChannelFifo)
+    analyzer(audioProcessor)
 {
     const auto& params = audioProcessor.getParameters();
     for (auto param : params)
@@ -220,126 +319,203 @@ ResponseCurveComponent::ResponseCurveComponent(EQAudioProcessor& p) :
         param->addListener(this);
     }
 
-    updateChain();
-    startTimer(16);
+    setOpaque(true);
+    updateChain({ true, true, true, true });
+    analyzerPool->addClient(&analyzer);
+    startTimerHz(60);
+}
+
+ResponseCurveComponent::~ResponseCurveComponent()
+{
+    analyzerPool->removeClient(&analyzer);
+
+    const auto& params = audioProcessor.getParameters();
+    for (auto param : params)
+    {
+        param->removeListener(this);
+    }
 }
+
 void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue)
 {
-    parametersChanged.set(true);
+    //the analyzer reads its own settings on the worker, only the bands concern the curve
+    if (auto* param = dynamic_cast<juce::AudioProcessorParameterWithID*>(audioProcessor.getParameters()[parameterIndex]))
+    {
+        if (param->paramID == "Oversampling")
+            changedBands.fetch_or((1 << NumBands) - 1);
+        else if (param->paramID == "Peak Design")
+            changedBands.fetch_or((1 << ChainPositions::Peak1) | (1 << ChainPositions::Peak2));
+        else if (isBandParameter(param->paramID))
+            changedBands.fetch_or(1 << getBandForParameter(param->paramID));
+    }
 }
 
-void ResponseCurveComponent::hiResTimerCallback()
+void ResponseCurveComponent::timerCallback()
 {
-    auto fftBounds = getRenderArea().toFloat();
-    auto sampleRate = audioProcessor.getSampleRate();
-    leftPathProducer.process(fftBounds, sampleRate);
-    rightPathProducer.process(fftBounds, sampleRate);
+    analyzer.setVisible(isShowing());
 
-    if (parametersChanged.compareAndSetBool(false, true))
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    if (openGLEnabled && glRenderer.hasFailed() && onRendererChange != nullptr)
+        onRendererChange(false);
+#endif
+
+    //in OpenGL mode the renderer is the one picking up the analyzer's frames
+    bool needsRepaint = !openGLEnabled && analyzer.pullNewFrame();
+
+    auto bandMask = changedBands.exchange(0);
+    if (audioProcessor.getSampleRate() != hostSampleRate)
+        bandMask = (1 << NumBands) - 1;
+
+    if (bandMask != 0)
     {
-        updateChain();
+        std::array<bool, NumBands> bands;
+        for (int band = 0; band < NumBands; ++band)
+            bands[band] = (bandMask & (1 << band)) != 0;
+
+        updateChain(bands);
+        needsRepaint = updateResponseCurve(bands) || needsRepaint;
     }
+
+    //the drop counts are painted in both modes, in OpenGL mode over the renderer along with the grid
+    const auto newDropCounts = analyzer.getDropCounts();
+    const auto dropCountsChanged = newDropCounts != dropCounts;
+    dropCounts = newDropCounts;
+
+    //the grid labels outside the render area never change, so only the area the layers cover is invalidated
+    if ((needsRepaint && !openGLEnabled) || dropCountsChanged)
+        repaint(getRenderArea());
+}
+
+void ResponseCurveComponent::setOpenGLEnabled(bool shouldBeEnabled)
+{
+    if (openGLEnabled == shouldBeEnabled)
+        return;
+
+    openGLEnabled = shouldBeEnabled;
+    setOpaque(!openGLEnabled);
+
+    //the grid is rebuilt with a transparent background in OpenGL mode
+    resized();
     repaint();
 }
 
-void ResponseCurveComponent::updateChain()
+void ResponseCurveComponent::mouseDown(const juce::MouseEvent& event)
+{
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    if (!event.mods.isPopupMenu())
+        return;
+
+    juce::PopupMenu menu;
+    menu.addItem(1, "Use OpenGL Renderer", true, openGLEnabled);
+
+    juce::Component::SafePointer<ResponseCurveComponent> safePtr(this);
+    menu.showMenuAsync(juce::PopupMenu::Options(), [safePtr](int result)
+    {
+        if (auto* comp = safePtr.getComponent())
+        {
+            if (result == 1 && comp->onRendererChange != nullptr)
+                comp->onRendererChange(!comp->openGLEnabled);
+        }
+    });
+#else
+    juce::ignoreUnused(event);
+#endif
+}
+
+void ResponseCurveComponent::updateChain(const std::array<bool, NumBands>& bandsToDesign)
 {
+    auto sampleRate = audioProcessor.getSampleRate();
     auto chainSettings = getChainSettings(audioProcessor.apvts);
 
-    monoChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypass);
-    monoChain.setBypassed<ChainPositions::Peak1>(chainSettings.peak1Bypass);
-    monoChain.setBypassed<ChainPositions::Peak2>(chainSettings.peak2Bypass);
-    monoChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypass);
+    //designed at the same oversampled rate as the processor's chain, so the curve shows the uncramped shape it applies
+    auto designRate = sampleRate * getOversamplingFactor(chainSettings, sampleRate, getMaxOversamplingFactor(audioProcessor.apvts));
+
+    auto bands = bandsToDesign;
+    if (designRate != chainSampleRate)
+        bands = { true, true, true, true };
+
+    hostSampleRate = sampleRate;
+    chainSampleRate = designRate;
+    if (chainSampleRate <= 0.0)
+        return;
+
+    //same designers as the processor, so the curve shows exactly what is being applied
+    designChainCoefficients(chainCoefficients, chainSettings, chainSampleRate, bands);
+}
 
-    auto peak1Coefficients = makePeak1(chainSettings, audioProcessor.getSampleRate());
-    auto peak2Coefficients = makePeak2(chainSettings, audioProcessor.getSampleRate());
+/**
+ everything the response curve depends on: the settings, the sample rate they were designed at and where the curve is drawn.
+ */
+static size_t getResponseCurveKey(const ChainSettings& chainSettings, double sampleRate, juce::Rectangle<int> area)
+{
+    size_t key = 0;
+    auto combine = [&key](auto value)
+    {
+        key ^= std::hash<decltype(value)>()(value) + 0x9e3779b9 + (key << 6) + (key >> 2);
+    };
 
-    updateCoefficients(monoChain.get<ChainPositions::Peak1>().coefficients, peak1Coefficients);
-    updateCoefficients(monoChain.get<ChainPositions::Peak2>().coefficients, peak2Coefficients);
+    for (auto value : { chainSettings.lowCutFreq, chainSettings.lowCutQ, chainSettings.highCutFreq, chainSettings.highCutQ,
+                        chainSettings.peak1Freq, chainSettings.peak1GainDB, chainSettings.peak1Q,
+                        chainSettings.peak2Freq, chainSettings.peak2GainDB, chainSettings.peak2Q })
+        combine(value);
 
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
+    for (auto value : { int(chainSettings.lowCutSlope), int(chainSettings.highCutSlope),
+                        int(chainSettings.lowCutBypass), int(chainSettings.highCutBypass),
+                        int(chainSettings.peak1Bypass), int(chainSettings.peak2Bypass), int(chainSettings.peakDesign),
+                        area.getX(), area.getY(), area.getWidth(), area.getHeight() })
+        combine(value);
 
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+    combine(sampleRate);
+    return key;
 }
 
-void ResponseCurveComponent::paint(juce::Graphics& g)
+bool ResponseCurveComponent::updateResponseCurve(const std::array<bool, NumBands>& bandsToUpdate)
 {
     using namespace juce;
 
     auto responseArea = getRenderArea();
-    auto w = responseArea.getWidth();
-    g.fillAll(Colours::black);
-    g.drawImage(background, getLocalBounds().toFloat());
-    
-    auto& lc = monoChain.get<ChainPositions::LowCut>();
-    auto& p1 = monoChain.get<ChainPositions::Peak1>();
-    auto& p2 = monoChain.get<ChainPositions::Peak2>();
-    auto& hc = monoChain.get<ChainPositions::HighCut>();
-    auto sampleRate = audioProcessor.getSampleRate();
+    const auto& settings = chainCoefficients.settings;
+    auto key = getResponseCurveKey(settings, chainSampleRate, responseArea);
+    if (key == responseCurveKey
+        && settings == responseCurveSettings
+        && chainSampleRate == responseCurveRate
+        && responseArea == responseCurveArea)
+        return false;
+
+    responseCurveKey = key;
+    responseCurveSettings = settings;
+    responseCurveRate = chainSampleRate;
+    responseCurveArea = responseArea;
+    responseCurve.clear();
+    curveLevels.clear();
+    curveLayerDirty = true;
 
-    std::vector<double> mags;
-    mags.resize(w);
+    auto w = responseArea.getWidth();
+    if (w <= 0 || chainSampleRate <= 0.0)
+        return true;
 
-    for (int i = 0; i < w; ++i)
+    auto bands = bandsToUpdate;
+    if (magnitudeResponse.getNumPoints() != w || responseSampleRate != chainSampleRate)
     {
-        double mag = 1.f;
-        auto freq = std::pow(2.0, (double(i) / double(w) * (std::log2(20000) - std::log2(20)) + std::log2(20)));
-        /*auto freq = (double(i) / double(w)) * (20000 - 20) + 20;*/
+        magnitudeResponse.prepare(w, 20.0, 20000.0, chainSampleRate);
+        responseSampleRate = chainSampleRate;
+        mags.resize((size_t)w);
+        for (auto& bandMagnitudes : bandMags)
+            bandMagnitudes.resize((size_t)w);
 
-        if (!monoChain.isBypassed<ChainPositions::Peak1>())
-        {
-            mag *= p1.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!monoChain.isBypassed<ChainPositions::Peak2>())
-        {
-            mag *= p2.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-
-        if (!monoChain.isBypassed<ChainPositions::LowCut>())
-        {
-            if (!lc.isBypassed<0>())
-            {
-                mag *= lc.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
-            if (!lc.isBypassed<1>())
-            {
-                mag *= lc.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
-            if (!lc.isBypassed<2>())
-            {
-                mag *= lc.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
-            if (!lc.isBypassed<3>())
-            {
-                mag *= lc.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
-        }
-        if (!monoChain.isBypassed<ChainPositions::HighCut>())
-        {
-            if (!hc.isBypassed<0>())
-            {
-                mag *= hc.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
-            if (!hc.isBypassed<1>())
-            {
-                mag *= hc.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
-            if (!hc.isBypassed<2>())
-            {
-                mag *= hc.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
-            if (!hc.isBypassed<3>())
-            {
-                mag *= hc.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
-        }
+        bands = { true, true, true, true };
+    }
 
-        mags[i] = Decibels::gainToDecibels(mag);
+    for (int band = 0; band < NumBands; ++band)
+    {
+        if (bands[band])
+            magnitudeResponse.processBand(chainCoefficients, ChainPositions(band), bandMags[band].data());
     }
 
-    Path responseCurve;
+    //the bands are in series, so their dB responses add up
+    FloatVectorOperations::add(mags.data(), bandMags[ChainPositions::LowCut].data(), bandMags[ChainPositions::Peak1].data(), w);
+    FloatVectorOperations::add(mags.data(), bandMags[ChainPositions::Peak2].data(), w);
+    FloatVectorOperations::add(mags.data(), bandMags[ChainPositions::HighCut].data(), w);
 
     const double outputMin = responseArea.getBottom();
     const double outputMax = responseArea.getY();
@@ -348,32 +524,109 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
         return jmap(input, -24.0, 24.0, outputMin, outputMax);
     };
 
-    responseCurve.startNewSubPath(responseArea.getX(), map(mags.front()));
+    curveLevels.resize(mags.size());
+    for (size_t i = 0; i < mags.size(); ++i)
+        curveLevels[i] = (float)map(mags[i]);
+
+    responseCurve.preallocateSpace(3 * w);
+    responseCurve.startNewSubPath(responseArea.getX(), curveLevels.front());
 
-    for (size_t i = 1; i < mags.size(); ++i)
+    for (size_t i = 1; i < curveLevels.size(); ++i)
     {
-        responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
+        responseCurve.lineTo(responseArea.getX() + i, curveLevels[i]);
     }
 
-    g.setColour(Colours::white.withAlpha(.6f));
-    auto leftChannelFFTPath = leftPathProducer.getPath();
-    leftChannelFFTPath = leftChannelFFTPath.createPathWithRoundedCorners(150.f);
-    leftChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
-    g.strokePath(leftChannelFFTPath, PathStrokeType(1.f));
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    if (openGLEnabled)
+        glRenderer.setCurve(curveLevels, (float)responseArea.getX());
+#endif
+
+    return true;
+}
 
-    auto rightChannelFFTPath = rightPathProducer.getPath();
-    rightChannelFFTPath = rightChannelFFTPath.createPathWithRoundedCorners(150.f);
-    rightChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
-    g.strokePath(rightChannelFFTPath, PathStrokeType(1.f));
+void ResponseCurveComponent::renderCurveLayer(float scale)
+{
+    using namespace juce;
 
+    auto width = roundToInt(getWidth() * scale);
+    auto height = roundToInt(getHeight() * scale);
+
+    if (curveLayer.getWidth() != width || curveLayer.getHeight() != height)
+        curveLayer = Image(Image::PixelFormat::ARGB, jmax(1, width), jmax(1, height), true);
+    else
+        curveLayer.clear(curveLayer.getBounds());
+
+    Graphics g(curveLayer);
+    g.addTransform(AffineTransform::scale(scale, scale));
     g.setColour(MainColor);
     g.strokePath(responseCurve, PathStrokeType(2.f));
+
+    curveLayerScale = scale;
+    curveLayerDirty = false;
+}
+
+void ResponseCurveComponent::paint(juce::Graphics& g)
+{
+    using namespace juce;
+
+    //layers, bottom to top: the grid image, the spectrum, which is the only thing stroked every frame,
+    //and the curve image, which is only re-rendered after an edit or a resize
+    if (openGLEnabled)
+    {
+        //just the grid, labels and drop counts, composited over what ResponseCurveGLRenderer drew
+        g.drawImage(background, getLocalBounds().toFloat());
+        drawDropCounts(g);
+        return;
+    }
+
+    g.fillAll(Colours::black);
+    g.drawImage(background, getLocalBounds().toFloat());
+
+    const auto& frame = analyzer.getFrame();
+    g.setColour(Colours::white.withAlpha(.6f));
+    g.strokePath(frame.fftPath, PathStrokeType(1.f));
+    g.strokePath(frame.overlayFFTPath, PathStrokeType(1.f));
+
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (curveLayerDirty || curveLayerScale != scale)
+        renderCurveLayer(scale);
+
+    g.drawImage(curveLayer, getLocalBounds().toFloat());
+    drawDropCounts(g);
+}
+
+void ResponseCurveComponent::drawDropCounts(juce::Graphics& g)
+{
+    if (!dropCounts.any())
+        return;
+
+    juce::String text;
+    text << "skipped " << dropCounts.skippedFrames << " frames, dropped "
+         << dropCounts.droppedFrames << " frames, " << dropCounts.droppedSamples << " samples";
+
+    g.setColour(juce::Colours::white.withAlpha(textAlpha));
+    g.setFont(juce::Font("Roboto", 8, 0));
+    g.drawFittedText(text, getRenderArea().reduced(4), juce::Justification::topRight, 1);
 }
 
 void ResponseCurveComponent::resized()
 {
     using namespace juce;
-    background = Image(Image::PixelFormat::RGB, getWidth(), getHeight(), true);
+    auto fftArea = getRenderArea();
+    analyzer.setBounds(fftArea.toFloat(), fftArea.getPosition().toFloat());
+    updateResponseCurve({});
+    curveLayerDirty = true;
+
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    if (openGLEnabled)
+    {
+        glRenderer.setCurve(curveLevels, (float)responseCurveArea.getX());
+        if (auto* parent = getParentComponent())
+            glRenderer.setTargetArea(getBoundsInParent(), parent->getLocalBounds());
+    }
+#endif
+
+    background = Image(openGLEnabled ? Image::PixelFormat::ARGB : Image::PixelFormat::RGB, getWidth(), getHeight(), true);
     Graphics g(background);
     auto renderArea = getRenderArea();
     auto left = renderArea.getX();
@@ -502,27 +755,508 @@ juce::Rectangle<int> ResponseCurveComponent::getRenderArea()
 
 //==============================================================================
 
-void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
+SpectrumAnalyzer::SpectrumAnalyzer(EQAudioProcessor& p) :
+    juce::ThreadPoolJob("EQ Spectrum Analyzer"),
+    audioProcessor(p),
+    pathProducer(audioProcessor.analyzerFifo),
+    overlayPathProducer(audioProcessor.overlayFifo),
+    orderParameter(audioProcessor.apvts.getRawParameterValue("Analyzer Order")),
+    overlapParameter(audioProcessor.apvts.getRawParameterValue("Analyzer Overlap")),
+    modeParameter(audioProcessor.apvts.getRawParameterValue("Analyzer Mode")),
+    decayParameter(audioProcessor.apvts.getRawParameterValue("Analyzer Decay")),
+    sourceParameter(audioProcessor.apvts.getRawParameterValue("Analyzer Source"))
+{
+}
+
+static FFTOrder getOrderForChoice(int choice)
+{
+    return FFTOrder(FFTOrder::order2048 + juce::jlimit(0, 2, choice));
+}
+
+static float getOverlapForChoice(int choice)
+{
+    static constexpr float overlaps[] = { .5f, .75f, .875f };
+    return overlaps[juce::jlimit(0, 2, choice)];
+}
+
+static float getDecayForChoice(int choice)
+{
+    static constexpr float decays[] = { 3.f, 6.f, 12.f, 24.f, 48.f };
+    return decays[juce::jlimit(0, 4, choice)];
+}
+
+//the producers' paths have exactly one point per pixel column, so their y values are the whole spectrum
+static void getColumnLevels(const juce::Path& path, std::vector<float>& levels)
 {
-    juce::AudioBuffer<float> tempIncomingBuffer;
+    levels.clear();
 
-    while (leftChannelFifo->getNumCompleteBuffersAvailable() > 0)
+    juce::PathFlatteningIterator segments(path);
+    while (segments.next())
     {
-        if (leftChannelFifo->getAudioBuffer(tempIncomingBuffer))
+        if (levels.empty())
+            levels.push_back(segments.y1);
+        levels.push_back(segments.y2);
+    }
+}
+
+void SpectrumAnalyzer::setBounds(juce::Rectangle<float> newFFTBounds, juce::Point<float> newOrigin)
+{
+    const juce::SpinLock::ScopedLockType sl(boundsLock);
+    fftBounds = newFFTBounds;
+    origin = newOrigin;
+}
+
+void SpectrumAnalyzer::analyse()
+{
+    juce::Rectangle<float> bounds;
+    juce::Point<float> offset;
+    {
+        const juce::SpinLock::ScopedLockType sl(boundsLock);
+        bounds = fftBounds;
+        offset = origin;
+    }
+
+    if (bounds.isEmpty())
+        return;
+
+    const auto order = getOrderForChoice(juce::roundToInt(orderParameter->load()));
+    const auto overlap = getOverlapForChoice(juce::roundToInt(overlapParameter->load()));
+    const auto mode = AnalyzerMode(juce::jlimit(0, 3, juce::roundToInt(modeParameter->load())));
+    const auto decay = getDecayForChoice(juce::roundToInt(decayParameter->load()));
+    const auto showOverlay = juce::roundToInt(sourceParameter->load()) == AnalyzerSource::Overlay;
+    auto sampleRate = audioProcessor.getSampleRate();
+
+    //everything the GUI would otherwise do per paint happens here, once per frame
+    auto& frame = frames.getWriteBuffer();
+    const auto translation = juce::AffineTransform::translation(offset.getX(), offset.getY());
+
+    pathProducer.setAnalysisSettings(order, overlap);
+    pathProducer.setBallistics(mode, decay);
+    pathProducer.process(bounds, sampleRate);
+
+    const auto fftPath = pathProducer.getPath();
+    frame.fftPath = fftPath.createPathWithRoundedCorners(150.f);
+    frame.fftPath.applyTransform(translation);
+    getColumnLevels(fftPath, frame.fftLevels);
+    frame.origin = offset;
+
+    //the processor only feeds the overlay fifo in Overlay, so there is nothing to transform otherwise
+    if (showOverlay)
+    {
+        overlayPathProducer.setAnalysisSettings(order, overlap);
+        overlayPathProducer.setBallistics(mode, decay);
+        overlayPathProducer.process(bounds, sampleRate);
+
+        const auto overlayPath = overlayPathProducer.getPath();
+        frame.overlayFFTPath = overlayPath.createPathWithRoundedCorners(150.f);
+        frame.overlayFFTPath.applyTransform(translation);
+        getColumnLevels(overlayPath, frame.overlayLevels);
+    }
+    else
+    {
+        frame.overlayFFTPath.clear();
+        frame.overlayLevels.clear();
+    }
+
+    frames.publish();
+}
+
+AnalyzerDropCounts SpectrumAnalyzer::getDropCounts() const
+{
+    AnalyzerDropCounts counts;
+    for (auto* producer : { &pathProducer, &overlayPathProducer })
+    {
+        counts.skippedFrames += producer->getNumSkippedFrames();
+        counts.droppedFrames += producer->getNumDroppedFrames();
+        counts.droppedSamples += producer->getNumDroppedSamples();
+    }
+    return counts;
+}
+
+juce::ThreadPoolJob::JobStatus SpectrumAnalyzer::runJob()
+{
+    analyse();
+    return jobHasFinished;
+}
+
+//==============================================================================
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+
+void ResponseCurveGLRenderer::newOpenGLContextCreated()
+{
+    using namespace juce;
+    failed.store(false);
+
+    //every line is a triangle strip with two vertices per pixel column, built here from the columns' y values.
+    //'column' is the column's x and which side of the line the vertex is on, 'previous' and 'next' are the
+    //neighbouring columns' y values, which give the normal to push the vertex out along.
+    //positions are logical pixels of the target component and are mapped straight to clip space
+    static const char* vertexShader =
+        "attribute vec2 column;\n"
+        "attribute float previous;\n"
+        "attribute float current;\n"
+        "attribute float next;\n"
+        "uniform vec2 viewportSize;\n"
+        "uniform vec2 offset;\n"
+        "uniform float halfWidth;\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 normal = normalize(vec2(previous - next, 2.0));\n"
+        "    vec2 p = (vec2(column.x, current) + normal * column.y * halfWidth + offset) / viewportSize;\n"
+        "    gl_Position = vec4(p.x * 2.0 - 1.0, 1.0 - p.y * 2.0, 0.0, 1.0);\n"
+        "}\n";
+
+    static const char* fragmentShader =
+        "uniform " JUCE_MEDIUMP " vec4 colour;\n"
+        "void main()\n"
+        "{\n"
+        "    gl_FragColor = colour;\n"
+        "}\n";
+
+    auto* context = OpenGLContext::getCurrentContext();
+    auto program = std::make_unique<OpenGLShaderProgram>(*context);
+
+    if (!program->addVertexShader(OpenGLHelpers::translateVertexShaderToV3(vertexShader))
+        || !program->addFragmentShader(OpenGLHelpers::translateFragmentShaderToV3(fragmentShader))
+        || !program->link())
+    {
+        DBG("response curve shader: " << program->getLastError());
+        failed.store(true);
+        return;
+    }
+
+    shader = std::move(program);
+    viewportSize = std::make_unique<OpenGLShaderProgram::Uniform>(*shader, "viewportSize");
+    offset = std::make_unique<OpenGLShaderProgram::Uniform>(*shader, "offset");
+    colour = std::make_unique<OpenGLShaderProgram::Uniform>(*shader, "colour");
+    halfWidth = std::make_unique<OpenGLShaderProgram::Uniform>(*shader, "halfWidth");
+    column = std::make_unique<OpenGLShaderProgram::Attribute>(*shader, "column");
+    previous = std::make_unique<OpenGLShaderProgram::Attribute>(*shader, "previous");
+    current = std::make_unique<OpenGLShaderProgram::Attribute>(*shader, "current");
+    next = std::make_unique<OpenGLShaderProgram::Attribute>(*shader, "next");
+
+    gl::glGenBuffers(1, &columnBuffer);
+    gl::glGenBuffers(1, &spectrumBuffer);
+    gl::glGenBuffers(1, &curveBuffer);
+
+    const ScopedLock sl(lock);
+    curveChanged = true;
+}
+
+void ResponseCurveGLRenderer::openGLContextClosing()
+{
+    if (shader != nullptr)
+    {
+        juce::gl::glDeleteBuffers(1, &columnBuffer);
+        juce::gl::glDeleteBuffers(1, &spectrumBuffer);
+        juce::gl::glDeleteBuffers(1, &curveBuffer);
+    }
+
+    next.reset();
+    current.reset();
+    previous.reset();
+    column.reset();
+    halfWidth.reset();
+    colour.reset();
+    offset.reset();
+    viewportSize.reset();
+    shader.reset();
+    numColumnsInBuffer = 0;
+    numCurveColumns = 0;
+}
+
+void ResponseCurveGLRenderer::setTargetArea(juce::Rectangle<int> componentBounds, juce::Rectangle<int> targetBounds)
+{
+    const juce::ScopedLock sl(lock);
+    area = componentBounds;
+    target = targetBounds;
+}
+
+void ResponseCurveGLRenderer::setCurve(const std::vector<float>& levels, float x)
+{
+    const juce::ScopedLock sl(lock);
+    curveLevels = levels;
+    curveX = x;
+    curveChanged = true;
+}
+
+void ResponseCurveGLRenderer::prepareColumns(int numColumns)
+{
+    using namespace juce::gl;
+
+    if (numColumns <= numColumnsInBuffer)
+        return;
+
+    //the columns only depend on the width, so they are uploaded once for the widest line drawn so far
+    std::vector<float> columns;
+    columns.reserve(size_t(numColumns) * 4);
+    for (int x = 0; x < numColumns; ++x)
+    {
+        for (auto side : { -1.f, 1.f })
+        {
+            columns.push_back(float(x));
+            columns.push_back(side);
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, columnBuffer);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(columns.size() * sizeof(float)), columns.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    numColumnsInBuffer = numColumns;
+}
+
+void ResponseCurveGLRenderer::uploadLevels(juce::uint32 buffer, const std::vector<float>& levels, juce::uint32 usage)
+{
+    using namespace juce::gl;
+
+    //each level once per side of the strip, with the end columns repeated so the first and last vertices have neighbours
+    paddedLevels.clear();
+    if (!levels.empty())
+    {
+        paddedLevels.insert(paddedLevels.end(), 2, levels.front());
+        for (auto level : levels)
+            paddedLevels.insert(paddedLevels.end(), 2, level);
+        paddedLevels.insert(paddedLevels.end(), 2, levels.back());
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(paddedLevels.size() * sizeof(float)), paddedLevels.data(), GLenum(usage));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ResponseCurveGLRenderer::drawColumnStrip(juce::uint32 buffer, int numColumns, juce::Point<float> stripOffset, juce::Colour stripColour, float stripHalfWidth)
+{
+    using namespace juce::gl;
+
+    if (numColumns < 2)
+        return;
+
+    prepareColumns(numColumns);
+
+    colour->set(stripColour.getFloatRed(), stripColour.getFloatGreen(), stripColour.getFloatBlue(), stripColour.getFloatAlpha());
+    offset->set(stripOffset.getX(), stripOffset.getY());
+    halfWidth->set(stripHalfWidth);
+
+    glBindBuffer(GL_ARRAY_BUFFER, columnBuffer);
+    glVertexAttribPointer(column->attributeID, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glEnableVertexAttribArray(column->attributeID);
+
+    //vertex v reads padded levels v, v + 2 and v + 4, i.e. the previous, its own and the next column
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    int index = 0;
+    for (auto* attribute : { previous.get(), current.get(), next.get() })
+    {
+        glVertexAttribPointer(attribute->attributeID, 1, GL_FLOAT, GL_FALSE, 0, (const void*)(2 * index++ * sizeof(float)));
+        glEnableVertexAttribArray(attribute->attributeID);
+    }
+
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 2 * numColumns);
+
+    for (auto* attribute : { column.get(), previous.get(), current.get(), next.get() })
+        glDisableVertexAttribArray(attribute->attributeID);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ResponseCurveGLRenderer::renderOpenGL()
+{
+    using namespace juce::gl;
+
+    juce::OpenGLHelpers::clear(juce::Colours::black);
+
+    if (shader == nullptr)
+        return;
+
+    juce::Rectangle<int> clipArea, targetArea;
+    {
+        const juce::ScopedLock sl(lock);
+        clipArea = area;
+        targetArea = target;
+
+        if (curveChanged)
         {
-            auto size = tempIncomingBuffer.getNumSamples();
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0),
-                monoBuffer.getReadPointer(0, size),
-                monoBuffer.getNumSamples() - size);
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size), tempIncomingBuffer.getReadPointer(0, 0), size);
-            leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -96.f);
+            uploadLevels(curveBuffer, curveLevels, GL_STATIC_DRAW);
+            numCurveColumns = int(curveLevels.size());
+            curveOrigin = curveX;
+            curveChanged = false;
         }
     }
+
+    if (targetArea.isEmpty())
+        return;
+
+    analyzer.pullNewFrame();
+    const auto& frame = analyzer.getFrame();
+
+    const auto scale = (float)juce::OpenGLContext::getCurrentContext()->getRenderingScale();
+    glViewport(0, 0, juce::roundToInt(scale * targetArea.getWidth()), juce::roundToInt(scale * targetArea.getHeight()));
+
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(juce::roundToInt(scale * clipArea.getX()),
+              juce::roundToInt(scale * (targetArea.getHeight() - clipArea.getBottom())),
+              juce::roundToInt(scale * clipArea.getWidth()),
+              juce::roundToInt(scale * clipArea.getHeight()));
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    shader->use();
+    viewportSize->set((GLfloat)targetArea.getWidth(), (GLfloat)targetArea.getHeight());
+    const auto clipOffset = clipArea.getPosition().toFloat();
+
+    //widths are in logical pixels, the same as the software renderer's strokes
+    for (auto* levels : { &frame.fftLevels, &frame.overlayLevels })
+    {
+        uploadLevels(spectrumBuffer, *levels, GL_STREAM_DRAW);
+        drawColumnStrip(spectrumBuffer, int(levels->size()), clipOffset + frame.origin, juce::Colours::white.withAlpha(.6f), .5f);
+    }
+
+    drawColumnStrip(curveBuffer, numCurveColumns, clipOffset + juce::Point<float>(curveOrigin, 0.f), MainColor, 1.f);
+
+    glDisable(GL_SCISSOR_TEST);
+}
+
+#endif
+
+//==============================================================================
+
+AnalyzerPool::AnalyzerPool() :
+    juce::Thread("EQ Analyzer Scheduler"),
+    workers(juce::jlimit(1, 4, juce::SystemStats::getNumCpus() / 4))
+{
+    startThread();
+}
+
+AnalyzerPool::~AnalyzerPool()
+{
+    stopThread(1000);
+    workers.removeAllJobs(true, 1000);
+}
+
+void AnalyzerPool::addClient(SpectrumAnalyzer* analyzer)
+{
+    const juce::ScopedLock sl(clientLock);
+    clients.addIfNotAlreadyThere(analyzer);
+}
+
+void AnalyzerPool::removeClient(SpectrumAnalyzer* analyzer)
+{
+    const juce::ScopedLock sl(clientLock);
+    clients.removeFirstMatchingValue(analyzer);
+
+    //the caller destroys the analyzer as soon as this returns, so a running pass has to finish first however long it takes
+    workers.removeJob(analyzer, true, -1);
+}
+
+void AnalyzerPool::run()
+{
+    while (!threadShouldExit())
+    {
+        const auto tickStart = juce::Time::getMillisecondCounterHiRes();
+        {
+            const juce::ScopedLock sl(clientLock);
+            ++tickCount;
+
+            //the pool runs jobs in the order they were added, so visible editors go first
+            queueClients(true);
+            if (tickCount % hiddenClientInterval == 0)
+                queueClients(false);
+        }
+
+        const auto elapsed = juce::Time::getMillisecondCounterHiRes() - tickStart;
+        wait(juce::jmax(1, tickIntervalMs - int(elapsed)));
+    }
+}
+
+void AnalyzerPool::queueClients(bool visibleClients)
+{
+    for (auto* client : clients)
+    {
+        //a client that is still busy from the last tick just skips this one
+        if (client->isVisible() == visibleClients && !workers.contains(client))
+            workers.addJob(client, false);
+    }
+}
+
+//==============================================================================
+
+void PathProducer::setAnalysisSettings(FFTOrder newOrder, float newOverlap)
+{
+    requestedOrder.store(newOrder);
+    requestedOverlap.store(newOverlap);
+}
+
+void PathProducer::setBallistics(AnalyzerMode newMode, float newDecayDBPerSecond)
+{
+    requestedMode.store(newMode);
+    requestedDecay.store(newDecayDBPerSecond);
+}
+
+void PathProducer::applyAnalysisSettings()
+{
+    const auto newOrder = requestedOrder.load();
+    if (newOrder != leftChannelFFTDataGenerator.getOrder())
+    {
+        leftChannelFFTDataGenerator.changeOrder(newOrder);
+
+        //the old window's contents are the wrong length now, start the new one from silence
+        monoBuffer.clear();
+        windowWritePosition = 0;
+    }
+
+    overlap = requestedOverlap.load();
+    const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
+    hopSize = juce::jlimit(1, fftSize, juce::roundToInt(fftSize * (1.f - overlap)));
+}
+
+void PathProducer::writeToWindow(const float* samples, int numSamples)
+{
+    //the buffer is sized for the largest order, the current window is its first fftSize samples
+    const auto windowSize = leftChannelFFTDataGenerator.getFFTSize();
+    auto* window = monoBuffer.getWritePointer(0);
+
+    while (numSamples > 0)
+    {
+        const auto numToCopy = juce::jmin(numSamples, windowSize - windowWritePosition);
+        juce::FloatVectorOperations::copy(window + windowWritePosition, samples, numToCopy);
+
+        windowWritePosition = (windowWritePosition + numToCopy) % windowSize;
+        samples += numToCopy;
+        numSamples -= numToCopy;
+    }
+}
+
+void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
+{
+    if (!leftChannelFifo->isPrepared())
+        return;
+
+    if (requestedOrder.load() != leftChannelFFTDataGenerator.getOrder() || requestedOverlap.load() != overlap)
+        applyAnalysisSettings();
+
+    //the decay is specified per second, but applied once per analysed frame
+    leftChannelFFTDataGenerator.setBallistics(requestedMode.load(), float(requestedDecay.load() * hopSize / sampleRate));
+
+    const auto numFrames = leftChannelFifo->getNumSamplesAvailable() / hopSize;
+    const auto framesToSkip = juce::jmax(0, numFrames - maxFramesPerProcess);
+    skippedFrames += framesToSkip;
+
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        auto [first, second] = leftChannelFifo->getSamples(hopSize);
+        writeToWindow(first.data, first.size);
+        writeToWindow(second.data, second.size);
+
+        leftChannelFifo->finishedRead(hopSize);
+
+        //frames we can't afford still move through the window, they just aren't analysed
+        if (frame >= framesToSkip)
+            leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer.getReadPointer(0), windowWritePosition, -96.f);
+    }
+
     const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
     const auto binWidth = sampleRate / double(fftSize);
     while (leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0)
     {
-        std::vector<float> fftData;
         if (leftChannelFFTDataGenerator.getFFTData(fftData))
         {
             pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -96.f);
@@ -559,20 +1293,38 @@ EQAudioProcessorEditor::EQAudioProcessorEditor(EQAudioProcessor& p)
     peak2QSliderAttachment(audioProcessor.apvts, "Peak2 Q", peak2QSlider),
     peak2BypassButtonAttachment(audioProcessor.apvts, "Peak2 Bypass", peak2BypassButton),
     lowCutFreqSliderAttachment(audioProcessor.apvts, "LowCut Freq", lowCutFreqSlider),
-    lowCutSlopeAttachment(audioProcessor.apvts, "LowCut Slope", lowCutSlope),
     lowCutQSliderAttachment(audioProcessor.apvts, "LowCut Q", lowCutQSlider),
     lowCutBypassButtonAttachment(audioProcessor.apvts, "LowCut Bypass", lowCutBypassButton),
     highCutFreqSliderAttachment(audioProcessor.apvts, "HighCut Freq", highCutFreqSlider),
-    highCutSlopeAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlope),
     highCutQSliderAttachment(audioProcessor.apvts, "HighCut Q", highCutQSlider),
     highCutBypassButtonAttachment(audioProcessor.apvts, "HighCut Bypass", highCutBypassButton)
 
 {
     juce::StringArray arr = {"Slope_12", "Slope_24", "Slope_36", "Slope_48"};
     lowCutSlope.addItemList(arr, 1);
-    lowCutSlope.setSelectedId(1);
     highCutSlope.addItemList(arr, 1);
-    highCutSlope.setSelectedId(1);
+
+    peakDesign.addItemList({ "RBJ Peaks", "Matched Peaks" }, 1);
+    linearPhase.addItemList({ "Linear Phase Off", "Linear 4096 taps", "Linear 8192 taps", "Linear 16384 taps" }, 1);
+    oversampling.addItemList({ "Oversampling Off", "Oversampling 2x", "Oversampling 4x" }, 1);
+    analyzerSource.addItemList({ "Left", "Right", "Mono (L+R)", "Mid", "Side", "L/R Overlay" }, 1);
+    analyzerOrder.addItemList({ "FFT 2048", "FFT 4096", "FFT 8192" }, 1);
+    analyzerOverlap.addItemList({ "Overlap 50%", "Overlap 75%", "Overlap 87.5%" }, 1);
+    analyzerMode.addItemList({ "Realtime", "Average", "Peak Hold", "Infinite Max" }, 1);
+    analyzerDecay.addItemList({ "3 dB/s", "6 dB/s", "12 dB/s", "24 dB/s", "48 dB/s" }, 1);
+
+    //the attachments select the parameter's item when they're made, which needs the items above
+    auto& apvts = audioProcessor.apvts;
+    lowCutSlopeAttachment = std::make_unique<ComboBoxAttachment>(apvts, "LowCut Slope", lowCutSlope);
+    highCutSlopeAttachment = std::make_unique<ComboBoxAttachment>(apvts, "HighCut Slope", highCutSlope);
+    oversamplingAttachment = std::make_unique<ComboBoxAttachment>(apvts, "Oversampling", oversampling);
+    peakDesignAttachment = std::make_unique<ComboBoxAttachment>(apvts, "Peak Design", peakDesign);
+    linearPhaseAttachment = std::make_unique<ComboBoxAttachment>(apvts, "Linear Phase", linearPhase);
+    analyzerSourceAttachment = std::make_unique<ComboBoxAttachment>(apvts, "Analyzer Source", analyzerSource);
+    analyzerOrderAttachment = std::make_unique<ComboBoxAttachment>(apvts, "Analyzer Order", analyzerOrder);
+    analyzerOverlapAttachment = std::make_unique<ComboBoxAttachment>(apvts, "Analyzer Overlap", analyzerOverlap);
+    analyzerModeAttachment = std::make_unique<ComboBoxAttachment>(apvts, "Analyzer Mode", analyzerMode);
+    analyzerDecayAttachment = std::make_unique<ComboBoxAttachment>(apvts, "Analyzer Decay", analyzerDecay);
 
     peak1FreqSlider.labels.add({ 0.f, "20Hz" });
     peak1FreqSlider.labels.add({ 1.f, "FREQ" });
@@ -619,6 +1371,14 @@ EQAudioProcessorEditor::EQAudioProcessorEditor(EQAudioProcessor& p)
 
     lowCutSlope.setLookAndFeel(&lnf);
     highCutSlope.setLookAndFeel(&lnf);
+    oversampling.setLookAndFeel(&lnf);
+    peakDesign.setLookAndFeel(&lnf);
+    linearPhase.setLookAndFeel(&lnf);
+    analyzerSource.setLookAndFeel(&lnf);
+    analyzerOrder.setLookAndFeel(&lnf);
+    analyzerOverlap.setLookAndFeel(&lnf);
+    analyzerMode.setLookAndFeel(&lnf);
+    analyzerDecay.setLookAndFeel(&lnf);
 
 
     auto safePtr = juce::Component::SafePointer<EQAudioProcessorEditor>(this);
@@ -663,11 +1423,59 @@ EQAudioProcessorEditor::EQAudioProcessorEditor(EQAudioProcessor& p)
         }
     };
 
-    setSize (800, 600);
+    responseCurveComponent.onRendererChange = [safePtr](bool useOpenGL)
+    {
+        if (auto* comp = safePtr.getComponent())
+            comp->setUseOpenGL(useOpenGL);
+    };
+
+    setSize (940, 600);
+    setUseOpenGL(audioProcessor.apvts.state.getProperty("UseOpenGL", false));
+}
+
+EQAudioProcessorEditor::~EQAudioProcessorEditor()
+{
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    openGLContext.detach();
+#endif
+}
+
+void EQAudioProcessorEditor::setUseOpenGL(bool shouldUseOpenGL)
+{
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    if (shouldUseOpenGL == openGLContext.isAttached())
+        return;
+
+    //the renderer and the message thread must never both read the analyzer's frames,
+    //so the component switches over before the context starts and after it has stopped
+    if (shouldUseOpenGL)
+    {
+        responseCurveComponent.setOpenGLEnabled(true);
+        openGLContext.setRenderer(&responseCurveComponent.getOpenGLRenderer());
+        openGLContext.setContinuousRepainting(true);
+        openGLContext.attachTo(*this);
+    }
+    else
+    {
+        openGLContext.detach();
+        openGLContext.setRenderer(nullptr);
+        responseCurveComponent.setOpenGLEnabled(false);
+    }
+
+    audioProcessor.apvts.state.setProperty("UseOpenGL", shouldUseOpenGL, nullptr);
+    repaint();
+#else
+    juce::ignoreUnused(shouldUseOpenGL);
+#endif
 }
 
 void EQAudioProcessorEditor::paint (juce::Graphics& g)
 {
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    //leave a hole for what ResponseCurveGLRenderer draws underneath
+    if (openGLContext.isAttached())
+        g.excludeClipRegion(responseCurveComponent.getBounds());
+#endif
     g.fillAll (BGColor);
 }
 
@@ -679,6 +1487,16 @@ void EQAudioProcessorEditor::resized()
 
     responseCurveComponent.setBounds(responseArea);
 
+    auto analyzerArea = bounds.removeFromTop(25);
+    oversampling.setBounds(analyzerArea.removeFromLeft(140));
+    peakDesign.setBounds(analyzerArea.removeFromLeft(120));
+    linearPhase.setBounds(analyzerArea.removeFromLeft(140));
+    analyzerDecay.setBounds(analyzerArea.removeFromRight(90));
+    analyzerMode.setBounds(analyzerArea.removeFromRight(110));
+    analyzerOverlap.setBounds(analyzerArea.removeFromRight(120));
+    analyzerOrder.setBounds(analyzerArea.removeFromRight(100));
+    analyzerSource.setBounds(analyzerArea.removeFromRight(110));
+
     auto lowCutArea = bounds.removeFromLeft(bounds.getWidth() * .25);
     auto highCutArea = bounds.removeFromRight(bounds.getWidth() * .33);
     auto peak1Area = bounds.removeFromRight(bounds.getWidth() * .5);
@@ -729,6 +1547,15 @@ std::vector<juce::Component*> EQAudioProcessorEditor::getComps()
         &highCutFreqSlider,
         &highCutQSlider,
         &highCutSlope,
-        &highCutBypassButton
+        &highCutBypassButton,
+
+        &oversampling,
+        &peakDesign,
+        &linearPhase,
+        &analyzerSource,
+        &analyzerOrder,
+        &analyzerOverlap,
+        &analyzerMode,
+        &analyzerDecay
     };
 }
@@ -18,19 +18,67 @@ enum FFTOrder
     order8192 = 13
 };
 
+/**
+ how successive spectra are combined before they are drawn.
+ */
+enum class AnalyzerMode
+{
+    Realtime,
+    Average,
+    PeakHold,
+    InfiniteMax
+};
+
+/**
+ the per-bin stage between the FFT and the dB conversion: exponential averaging, peak-hold with decay,
+ or an infinite max. it works on whole magnitude arrays through FloatVectorOperations and keeps its
+ held spectrum from one frame to the next.
+ */
+struct SpectrumBallistics
+{
+    void prepare(int maxNumBins);
+
+    /** the next frame replaces the held spectrum rather than being combined with it. */
+    void reset() { primed = false; }
+
+    /**
+     'decayDBPerFrame' is how far a held peak falls per frame. averaging uses the matching time constant,
+     so both modes release at the same rate.
+     */
+    void setMode(AnalyzerMode newMode, float decayDBPerFrame);
+    void process(float* magnitudes, int numBins);
+private:
+    std::vector<float> held;
+    AnalyzerMode mode = AnalyzerMode::Realtime;
+    float decayGain = 1.f;
+    bool primed = false;
+};
+
+/**
+ replaces NaN and inf magnitudes with 0, so one bad frame can't stick in the ballistics' held spectrum.
+ */
+void zeroNonFiniteMagnitudes(float* data, int numValues);
+
+/**
+ converts magnitudes to dB in place, floored at 'minusInfinityDb', which is also where non-finite values end up.
+ there is no per-bin branch or library call, only selects, so the loop vectorizes.
+ */
+void magnitudesToDecibels(float* data, int numValues, float minusInfinityDb);
+
 template<typename BlockType>
 struct FFTDataGenerator
 {
     /**
-     produces the FFT data from an audio buffer.
+     produces the FFT data from a circular window of getFFTSize() samples, whose oldest sample is at 'oldestSample'.
+     the window is unrolled while it is copied into the FFT buffer, which has to happen anyway, so it never needs shifting.
      */
-    void produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData, const float negativeInfinity)
+    void produceFFTDataForRendering(const float* circularWindow, int oldestSample, const float negativeInfinity)
     {
         const auto fftSize = getFFTSize();
 
         fftData.assign(fftData.size(), 0);
-        auto* readIndex = audioData.getReadPointer(0);
-        std::copy(readIndex, readIndex + fftSize, fftData.begin());
+        std::copy(circularWindow + oldestSample, circularWindow + fftSize, fftData.begin());
+        std::copy(circularWindow, circularWindow + oldestSample, fftData.begin() + (fftSize - oldestSample));
 
         // first apply a windowing function to our data
         window->multiplyWithWindowingTable(fftData.data(), fftSize);       // [1]
@@ -40,67 +88,79 @@ struct FFTDataGenerator
 
         int numBins = (int)fftSize / 2;
 
-        //normalize the fft values.
-        for (int i = 0; i < numBins; ++i)
-        {
-            auto v = fftData[i];
-            //            fftData[i] /= (float) numBins;
-            if (!std::isinf(v) && !std::isnan(v))
-            {
-                v /= float(numBins);
-            }
-            else
-            {
-                v = 0.f;
-            }
-            fftData[i] = v;
-        }
+        //normalize the fft values, combine them with the previous frames and convert them to decibels
+        juce::FloatVectorOperations::multiply(fftData.data(), 1.f / float(numBins), numBins);
+        zeroNonFiniteMagnitudes(fftData.data(), numBins);
+        ballistics.process(fftData.data(), numBins);
+        magnitudesToDecibels(fftData.data(), numBins, negativeInfinity);
 
-        //convert them to decibels
-        for (int i = 0; i < numBins; ++i)
+        if (!fftDataFifo.push(fftData))
+            ++droppedFrames;
+    }
+
+    /**
+     builds the FFT plan and window for every supported order up front, so switching between them later never allocates.
+     */
+    void prepare()
+    {
+        for (int order = minOrder; order <= maxOrder; ++order)
         {
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
+            const auto fftSize = size_t(1) << order;
+            forwardFFTs[order - minOrder] = std::make_unique<juce::dsp::FFT>(order);
+            windows[order - minOrder] = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
         }
 
-        fftDataFifo.push(fftData);
+        fftData.clear();
+        fftData.resize(size_t(2) << maxOrder, 0);
+
+        fftDataFifo.prepare(fftData.size());
+        ballistics.prepare(maxFFTSize / 2);
+        changeOrder(order);
     }
 
+    /**
+     switches to one of the prepared plans. frames of the old size still waiting in the fifo are dropped.
+     must be called from the thread that produces and reads the FFT data.
+     */
     void changeOrder(FFTOrder newOrder)
     {
-        //when you change order, recreate the window, forwardFFT, fifo, fftData
-        //also reset the fifoIndex
-        //things that need recreating should be created on the heap via std::make_unique<>
-
         order = newOrder;
-        auto fftSize = getFFTSize();
+        forwardFFT = forwardFFTs[order - minOrder].get();
+        window = windows[order - minOrder].get();
 
-        forwardFFT = std::make_unique<juce::dsp::FFT>(order);
-        window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
-
-        fftData.clear();
-        fftData.resize(fftSize * 2, 0);
-
-        fftDataFifo.prepare(fftData.size());
+        while (fftDataFifo.pull(fftData)) {}
+        ballistics.reset();
     }
+
+    void setBallistics(AnalyzerMode mode, float decayDBPerFrame) { ballistics.setMode(mode, decayDBPerFrame); }
     //==============================================================================
     int getFFTSize() const { return 1 << order; }
+    FFTOrder getOrder() const { return order; }
     int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
+    int getNumDroppedFrames() const { return droppedFrames.load(); }
     //==============================================================================
     bool getFFTData(BlockType& fftData) { return fftDataFifo.pull(fftData); }
+
+    static constexpr FFTOrder minOrder = FFTOrder::order2048, maxOrder = FFTOrder::order8192;
+    static constexpr int maxFFTSize = 1 << maxOrder;
 private:
-    FFTOrder order;
+    FFTOrder order = FFTOrder::order4096;
     BlockType fftData;
-    std::unique_ptr<juce::dsp::FFT> forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    std::array<std::unique_ptr<juce::dsp::FFT>, maxOrder - minOrder + 1> forwardFFTs;
+    std::array<std::unique_ptr<juce::dsp::WindowingFunction<float>>, maxOrder - minOrder + 1> windows;
+    juce::dsp::FFT* forwardFFT = nullptr;
+    juce::dsp::WindowingFunction<float>* window = nullptr;
+    SpectrumBallistics ballistics;
 
     Fifo<BlockType> fftDataFifo;
+    std::atomic<int> droppedFrames{ 0 };
 };
 
 template<typename PathType>
 struct AnalyzerPathGenerator
 {
     /*
-     converts 'renderData[]' into a juce::Path
+     converts 'renderData[]' into a juce::Path with exactly one point per pixel column
      */
     void generatePath(const std::vector<float>& renderData,
         juce::Rectangle<float> fftBounds,
@@ -110,12 +170,13 @@ struct AnalyzerPathGenerator
     {
         auto top = fftBounds.getY();
         auto bottom = fftBounds.getHeight();
-        auto width = fftBounds.getWidth();
+        auto width = (int)fftBounds.getWidth();
 
-        int numBins = (int)fftSize / 2;
+        if (width != mapWidth || fftSize != mapFFTSize || binWidth != mapBinWidth)
+            buildColumnMap(width, fftSize, binWidth);
 
         PathType p;
-        p.preallocateSpace(3 * (int)fftBounds.getWidth());
+        p.preallocateSpace(3 * width);
 
         auto map = [bottom, top, negativeInfinity](float v)
         {
@@ -124,29 +185,14 @@ struct AnalyzerPathGenerator
                 float(bottom + 10), top);
         };
 
-        auto y = map(renderData[0]);
-
-        //        jassert( !std::isnan(y) && !std::isinf(y) );
-        if (std::isnan(y) || std::isinf(y))
-            y = bottom;
-
-        p.startNewSubPath(0, y);
-
-        const int pathResolution = 2; //you can draw line-to's every 'pathResolution' pixels.
-
-        for (int binNum = 1; binNum < numBins; binNum += pathResolution)
+        for (int x = 0; x < width; ++x)
         {
-            y = map(renderData[binNum]);
-
-            //            jassert( !std::isnan(y) && !std::isinf(y) );
+            auto y = map(juce::jmax(getColumnValue(renderData, columns[x]), negativeInfinity));
 
-            if (!std::isnan(y) && !std::isinf(y))
-            {
-                auto binFreq = binNum * binWidth;
-                auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
-                int binX = std::floor(normalizedBinX * width);
-                p.lineTo(binX, y);
-            }
+            if (x == 0)
+                p.startNewSubPath(0, y);
+            else
+                p.lineTo(x, y);
         }
 
         pathFifo.push(p);
@@ -163,6 +209,54 @@ struct AnalyzerPathGenerator
     }
 private:
     Fifo<PathType> pathFifo;
+
+    /**
+     the bins whose centre frequencies land in one pixel column. columns narrower than a bin have none,
+     and interpolate between the two bins around the column's centre frequency instead.
+     */
+    struct Column
+    {
+        int firstBin = 0, numBins = 0;
+        float centreBin = 0.f;
+    };
+
+    std::vector<Column> columns;
+    int mapWidth = 0, mapFFTSize = 0;
+    float mapBinWidth = 0.f;
+
+    void buildColumnMap(int width, int fftSize, float binWidth)
+    {
+        const int numBins = fftSize / 2;
+        auto getColumnFrequency = [width](float x) { return juce::mapToLog10(x / float(width), 20.f, 20000.f); };
+        auto getFirstBinAbove = [binWidth, numBins](float freq) { return juce::jlimit(1, numBins, (int)std::ceil(freq / binWidth)); };
+
+        columns.resize((size_t)juce::jmax(0, width));
+        for (int x = 0; x < width; ++x)
+        {
+            auto& column = columns[x];
+            column.firstBin = getFirstBinAbove(getColumnFrequency(float(x)));
+            column.numBins = getFirstBinAbove(getColumnFrequency(float(x + 1))) - column.firstBin;
+            column.centreBin = juce::jlimit(0.f, float(numBins - 1), getColumnFrequency(x + .5f) / binWidth);
+        }
+
+        mapWidth = width;
+        mapFFTSize = fftSize;
+        mapBinWidth = binWidth;
+    }
+
+    float getColumnValue(const std::vector<float>& renderData, const Column& column) const
+    {
+        if (column.numBins == 0)
+        {
+            const auto lowerBin = (int)column.centreBin;
+            const auto upperBin = juce::jmin(lowerBin + 1, mapFFTSize / 2 - 1);
+            return juce::jmap(column.centreBin - float(lowerBin), renderData[lowerBin], renderData[upperBin]);
+        }
+
+        //the loudest bin in the column, so narrow peaks aren't averaged away where the columns are wide
+        const auto* first = renderData.data() + column.firstBin;
+        return *std::max_element(first, first + column.numBins);
+    }
 };
 
 struct LookAndFeel : juce::LookAndFeel_V4
@@ -225,38 +319,272 @@ struct PathProducer
 {
     PathProducer(SingleChannelSampleFifo<EQAudioProcessor::BlockType>& scsf) : leftChannelFifo(&scsf)
     {
-        leftChannelFFTDataGenerator.changeOrder(FFTOrder::order4096);
-        monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+        //sized for the largest order, so a resolution change never touches the heap
+        leftChannelFFTDataGenerator.prepare();
+        monoBuffer.setSize(1, FFTDataGenerator<std::vector<float>>::maxFFTSize);
+        monoBuffer.clear();
+        fftData.resize(FFTDataGenerator<std::vector<float>>::maxFFTSize * 2, 0);
+        applyAnalysisSettings();
     }
     void process(juce::Rectangle<float> fftBounds, double sampleRate);
     juce::Path getPath() { return leftChannelFFTPath; }
+
+    /**
+     the FFT order, and how much consecutive FFT frames overlap, e.g. .5f or .75f.
+     the hop between frames follows from these alone, whatever block size the host uses.
+     can be called from any thread, the change is picked up at the start of the next process() call.
+     */
+    void setAnalysisSettings(FFTOrder newOrder, float newOverlap);
+    int getHopSize() const { return hopSize; }
+
+    /** same threading as setAnalysisSettings. */
+    void setBallistics(AnalyzerMode newMode, float newDecayDBPerSecond);
+
+    //frames that were shifted through the window without being analysed, because the analyzer had fallen behind.
+    //these counters can be read from any thread
+    int getNumSkippedFrames() const { return skippedFrames.load(); }
+    int getNumDroppedFrames() const { return leftChannelFFTDataGenerator.getNumDroppedFrames(); }
+    int getNumDroppedSamples() const { return leftChannelFifo->getNumDroppedSamples(); }
 private:
+    //caps how many FFTs a single process() call may run, however far behind the analyzer is
+    static constexpr int maxFramesPerProcess = 4;
+
     SingleChannelSampleFifo<EQAudioProcessor::BlockType>* leftChannelFifo;
+    std::atomic<FFTOrder> requestedOrder{ FFTOrder::order4096 };
+    std::atomic<float> requestedOverlap{ 0.75f };
+    std::atomic<AnalyzerMode> requestedMode{ AnalyzerMode::Realtime };
+    std::atomic<float> requestedDecay{ 12.f };
+    float overlap = 0.f;
+    void applyAnalysisSettings();
+    int hopSize = 0;
+    //where the next hop goes in the circular window, which is also where its oldest sample sits
+    int windowWritePosition = 0;
+    void writeToWindow(const float* samples, int numSamples);
+    std::atomic<int> skippedFrames{ 0 };
     juce::AudioBuffer<float> monoBuffer;
+    std::vector<float> fftData;
     FFTDataGenerator<std::vector<float>>leftChannelFFTDataGenerator;
     AnalyzerPathGenerator<juce::Path> pathProducer;
     juce::Path leftChannelFFTPath;
 };
 
+/**
+ one finished analyzer picture. once published it is never written again, so the GUI can draw it without locking.
+ */
+struct AnalyzerFrame
+{
+    juce::Path fftPath;
+    //only drawn in the L/R Overlay source, empty otherwise
+    juce::Path overlayFFTPath;
+
+    //the same spectra as one y per pixel column, the first column at 'origin'. this is all the GPU renderer uploads
+    std::vector<float> fftLevels, overlayLevels;
+    juce::Point<float> origin;
+};
+
+/**
+ what the analyzer has lost since it was opened, because the GUI couldn't keep up with the audio.
+ */
+struct AnalyzerDropCounts
+{
+    int skippedFrames = 0, droppedFrames = 0, droppedSamples = 0;
+
+    bool any() const { return skippedFrames + droppedFrames + droppedSamples > 0; }
+    bool operator== (const AnalyzerDropCounts& other) const
+    {
+        return skippedFrames == other.skippedFrames && droppedFrames == other.droppedFrames && droppedSamples == other.droppedSamples;
+    }
+    bool operator!= (const AnalyzerDropCounts& other) const { return !(*this == other); }
+};
+
+/**
+ runs the PathProducers for the selected analyzer source and publishes the result as an AnalyzerFrame.
+ analyse() runs on one of the AnalyzerPool's workers, everything else is called from the message thread.
+ */
+struct SpectrumAnalyzer : juce::ThreadPoolJob
+{
+    SpectrumAnalyzer(EQAudioProcessor& p);
+
+    void setBounds(juce::Rectangle<float> newFFTBounds, juce::Point<float> newOrigin);
+    void analyse();
+    JobStatus runJob() override;
+
+    /** hidden analyzers are serviced less often than the ones on screen. */
+    void setVisible(bool isNowVisible) { visible.store(isNowVisible); }
+    bool isVisible() const { return visible.load(); }
+
+    /** picks up the newest frame, if a new one was published since the last call. */
+    bool pullNewFrame() { return frames.acquire(); }
+    const AnalyzerFrame& getFrame() const { return frames.getReadBuffer(); }
+
+    /** summed over both channels' producers, can be called from any thread. */
+    AnalyzerDropCounts getDropCounts() const;
+private:
+    EQAudioProcessor& audioProcessor;
+    PathProducer pathProducer, overlayPathProducer;
+
+    juce::SpinLock boundsLock;
+    juce::Rectangle<float> fftBounds;
+    juce::Point<float> origin;
+
+    //the analyzer's choice parameters, read on the worker before each analysis pass
+    std::atomic<float>* orderParameter = nullptr;
+    std::atomic<float>* overlapParameter = nullptr;
+    std::atomic<float>* modeParameter = nullptr;
+    std::atomic<float>* decayParameter = nullptr;
+    std::atomic<float>* sourceParameter = nullptr;
+
+    TripleBuffer<AnalyzerFrame> frames;
+    std::atomic<bool> visible{ true };
+};
+
+/**
+ one analysis scheduler shared by every editor in the process, held through a juce::SharedResourcePointer.
+ a single ticker thread wakes once per frame for all of them and queues their SpectrumAnalyzers on a
+ fixed-size pool of workers, visible ones first. so the thread count and the number of wakeups stay
+ the same however many instances are open.
+ */
+struct AnalyzerPool : private juce::Thread
+{
+    AnalyzerPool();
+    ~AnalyzerPool() override;
+
+    void addClient(SpectrumAnalyzer* analyzer);
+
+    /** blocks until 'analyzer' is no longer being run. */
+    void removeClient(SpectrumAnalyzer* analyzer);
+private:
+    static constexpr int tickIntervalMs = 16;
+    //hidden editors still need their fifos drained, just not at frame rate
+    static constexpr int hiddenClientInterval = 8;
+
+    juce::ThreadPool workers;
+    juce::CriticalSection clientLock;
+    juce::Array<SpectrumAnalyzer*> clients;
+    int tickCount = 0;
+
+    void run() override;
+    void queueClients(bool visibleClients);
+};
+
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+/**
+ draws the spectrum and the response curve with a small line shader, underneath the component tree.
+ the editor leaves the response area transparent while this is active, so the grid and labels the
+ ResponseCurveComponent still paints are composited on top by the OpenGLContext.
+ the context repaints continuously and this renderer is then the only reader of the analyzer's frames.
+ */
+struct ResponseCurveGLRenderer : juce::OpenGLRenderer
+{
+    explicit ResponseCurveGLRenderer(SpectrumAnalyzer& analyzerToDraw) : analyzer(analyzerToDraw) {}
+
+    void newOpenGLContextCreated() override;
+    void renderOpenGL() override;
+    void openGLContextClosing() override;
+
+    /** where the response component sits in the component the context is attached to, in logical pixels. */
+    void setTargetArea(juce::Rectangle<int> componentBounds, juce::Rectangle<int> targetBounds);
+    /** the response curve as one y per pixel column, the first one at x. */
+    void setCurve(const std::vector<float>& levels, float x);
+
+    /** true once the context came up without a usable shader, so the caller can fall back to software. */
+    bool hasFailed() const { return failed.load(); }
+private:
+    SpectrumAnalyzer& analyzer;
+
+    std::unique_ptr<juce::OpenGLShaderProgram> shader;
+    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> viewportSize, offset, colour, halfWidth;
+    std::unique_ptr<juce::OpenGLShaderProgram::Attribute> column, previous, current, next;
+    juce::uint32 columnBuffer = 0, spectrumBuffer = 0, curveBuffer = 0;
+    std::atomic<bool> failed{ false };
+
+    juce::CriticalSection lock;
+    juce::Rectangle<int> area, target;
+    std::vector<float> curveLevels;
+    float curveX = 0.f;
+    bool curveChanged = false;
+
+    //only touched on the GL thread
+    std::vector<float> paddedLevels;
+    int numColumnsInBuffer = 0, numCurveColumns = 0;
+    float curveOrigin = 0.f;
+
+    void prepareColumns(int numColumns);
+    void uploadLevels(juce::uint32 buffer, const std::vector<float>& levels, juce::uint32 usage);
+    void drawColumnStrip(juce::uint32 buffer, int numColumns, juce::Point<float> stripOffset, juce::Colour stripColour, float stripHalfWidth);
+};
+#endif
+
 struct ResponseCurveComponent : juce::Component,
     juce::AudioProcessorParameter::Listener,
-    juce::HighResolutionTimer
+    juce::Timer
 {
     ResponseCurveComponent(EQAudioProcessor&);
+    ~ResponseCurveComponent() override;
+
+    /** called from the right-click menu, and when the GPU renderer turns out to be unusable. */
+    std::function<void(bool useOpenGL)> onRendererChange;
+
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    ResponseCurveGLRenderer& getOpenGLRenderer() { return glRenderer; }
+#endif
+    /** in OpenGL mode the spectrum and curve are left to the renderer and only the grid is painted. */
+    void setOpenGLEnabled(bool shouldBeEnabled);
+    void mouseDown(const juce::MouseEvent& event) override;
+
     void parameterValueChanged(int parameterIndex, float newValue) override;
     void parameterGestureChanged(int parameterIndex, bool genstureIsStarting) override {};
-    void hiResTimerCallback() override;
+    void timerCallback() override;
     void paint(juce::Graphics& g) override;
     void resized() override;
 
 private:
     EQAudioProcessor& audioProcessor;
-    juce::Atomic<bool> parametersChanged{ false };
-    MonoChain monoChain;
-    void updateChain();
+    //one bit per ChainPositions band whose parameters moved since the last timer tick
+    std::atomic<int> changedBands{ 0 };
+    ChainCoefficients chainCoefficients;
+    //the host's rate, and the rate the chain is designed at, which is higher while the processor oversamples
+    double hostSampleRate = 0.0;
+    double chainSampleRate = 0.0;
+    void updateChain(const std::array<bool, NumBands>& bandsToDesign);
+    MagnitudeResponse magnitudeResponse;
+    double responseSampleRate = 0.0;
+    std::array<std::vector<double>, NumBands> bandMags;
+    std::vector<double> mags;
+
+    /**
+     rebuilds the flagged bands' responses, their sum and the curve path, if the settings,
+     sample rate or render area moved since the last build.
+     */
+    bool updateResponseCurve(const std::array<bool, NumBands>& bandsToUpdate);
+    //the hash is only a quick check, the inputs it was built from decide whether the curve is still valid
+    size_t responseCurveKey = 0;
+    ChainSettings responseCurveSettings;
+    double responseCurveRate = 0.0;
+    juce::Rectangle<int> responseCurveArea;
+    juce::Path responseCurve;
+    //the curve's y per pixel column, which is what the GL renderer draws from
+    std::vector<float> curveLevels;
+
+    /** the stroked curve at the display's physical resolution, so a frame only blits it. */
+    juce::Image curveLayer;
+    float curveLayerScale = 1.f;
+    bool curveLayerDirty = true;
+    void renderCurveLayer(float scale);
+
     juce::Image background;
     juce::Rectangle<int> getRenderArea();
-    PathProducer leftPathProducer, rightPathProducer;
+    SpectrumAnalyzer analyzer;
+
+    //the counts last drawn in the analyzer's corner, which only repaints when they change
+    AnalyzerDropCounts dropCounts;
+    void drawDropCounts(juce::Graphics& g);
+    juce::SharedResourcePointer<AnalyzerPool> analyzerPool;
+
+    bool openGLEnabled = false;
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    ResponseCurveGLRenderer glRenderer{ analyzer };
+#endif
 };
 
 //==============================================================================
@@ -266,12 +594,19 @@ class EQAudioProcessorEditor : public juce::AudioProcessorEditor
 {
 public:
     EQAudioProcessorEditor (EQAudioProcessor&);
+    ~EQAudioProcessorEditor() override;
     void paint (juce::Graphics&) override;
     void resized() override;
 private:
     EQAudioProcessor& audioProcessor;
     ResponseCurveComponent responseCurveComponent;
 
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    juce::OpenGLContext openGLContext;
+#endif
+    /** switches between the software and the OpenGL renderer. the choice is stored with the plugin state. */
+    void setUseOpenGL(bool shouldUseOpenGL);
+
     using APVTS = juce::AudioProcessorValueTreeState;
     using SliderAttachment = APVTS::SliderAttachment;
     using ComboBoxAttachment = APVTS::ComboBoxAttachment;
@@ -310,8 +645,13 @@ private:
         peak1BypassButtonAttachment, 
         peak2BypassButtonAttachment;
     juce::ComboBox lowCutSlope, highCutSlope;
-    ComboBoxAttachment lowCutSlopeAttachment,
+    std::unique_ptr<ComboBoxAttachment> lowCutSlopeAttachment,
         highCutSlopeAttachment;
+    juce::ComboBox oversampling, peakDesign, linearPhase;
+    std::unique_ptr<ComboBoxAttachment> oversamplingAttachment, peakDesignAttachment, linearPhaseAttachment;
+
+    juce::ComboBox analyzerSource, analyzerOrder, analyzerOverlap, analyzerMode, analyzerDecay;
+    std::unique_ptr<ComboBoxAttachment> analyzerSourceAttachment, analyzerOrderAttachment, analyzerOverlapAttachment, analyzerModeAttachment, analyzerDecayAttachment;
 
     std::vector<juce::Component*> getComps();
     LookAndFeel lnf;
@@ -22,10 +22,37 @@ EQAudioProcessor::EQAudioProcessor()
                        )
 #endif
 {
+    for (auto* param : getParameters())
+    {
+        auto* paramWithID = dynamic_cast<juce::AudioProcessorParameterWithID*>(param);
+        if (paramWithID != nullptr && !isAnalyzerParameter(paramWithID->paramID))
+        {
+            apvts.addParameterListener(paramWithID->paramID, this);
+        }
+    }
+
+    analyzerSource = apvts.getRawParameterValue("Analyzer Source");
+    oversamplingChoice = apvts.getRawParameterValue("Oversampling");
+    linearPhaseChoice = apvts.getRawParameterValue("Linear Phase");
+    smoothingTime = apvts.getRawParameterValue("Smoothing Time");
+    smoothingIntervalChoice = apvts.getRawParameterValue("Smoothing Interval");
+    parallelProcessing = apvts.getRawParameterValue("Parallel Processing");
+
+    startTimerHz(20);
 }
 
 EQAudioProcessor::~EQAudioProcessor()
 {
+    stopTimer();
+
+    for (auto* param : getParameters())
+    {
+        auto* paramWithID = dynamic_cast<juce::AudioProcessorParameterWithID*>(param);
+        if (paramWithID != nullptr && !isAnalyzerParameter(paramWithID->paramID))
+        {
+            apvts.removeParameterListener(paramWithID->paramID, this);
+        }
+    }
 }
 
 //==============================================================================
@@ -63,7 +90,8 @@ bool EQAudioProcessor::isMidiEffect() const
 
 double EQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    const auto sampleRate = getSampleRate();
+    return sampleRate > 0.0 ? tailSamples.load() / sampleRate : 0.0;
 }
 
 int EQAudioProcessor::getNumPrograms()
@@ -95,21 +123,71 @@ void EQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     juce::dsp::ProcessSpec spec;
     spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
+    spec.numChannels = getTotalNumOutputChannels();
     spec.sampleRate = sampleRate;
+    preparedBlockSize = size_t(samplesPerBlock);
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
-    leftChannelFifo.prepare(samplesPerBlock);
-    rightChannelFifo.prepare(samplesPerBlock);
+    for (size_t i = 0; i < oversamplers.size(); ++i)
+    {
+        oversamplers[i] = std::make_unique<juce::dsp::Oversampling<float>>(spec.numChannels, i + 1,
+            juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true, true);
+        oversamplers[i]->initProcessing(samplesPerBlock);
+    }
 
-    updateFilters();
+    latencyDelay.setMaximumDelayInSamples(juce::roundToInt(getOversampler(4).getLatencyInSamples()) + 1);
+    latencyDelay.prepare(spec);
+
+    for (auto& convolver : convolvers)
+        convolver.prepare(int(spec.numChannels), maxLinearPhaseLength);
+    activeConvolver = 0;
+    lengthChangePending = false;
+    getConvolver().setLength(getLinearPhaseLength(linearPhaseChoice->load()));
+    lengthChangeBuffer.setSize(int(spec.numChannels), samplesPerBlock);
+    setOversamplingLatency(getMaxOversamplingFactor(apvts));
+    //hosts expect the latency to be known by the time prepareToPlay returns
+    pendingLatency.store(getPathLatency());
+    setLatencySamples(pendingLatency.load());
+    tailSamples.store(getConvolver().getLength() > 0 ? getConvolver().getLength() + getConvolver().getLatency() : 0);
+
+    //room for the largest oversampled block
+    auto chainSpec = spec;
+    chainSpec.maximumBlockSize = samplesPerBlock * 4;
+    chain.prepare(chainSpec);
+    fadeChain.prepare(chainSpec);
+    fadeBuffer.setSize(int(spec.numChannels), samplesPerBlock);
+    preparedNumWorkers.store(juce::jmin(chain.getNumGroups() - 1, maxChannelWorkers, juce::SystemStats::getNumCpus() - 1));
+    preparedBlockPeriodMs.store(1000.0 * samplesPerBlock / sampleRate);
+    channelWorkers.stop();
+    if (isParallelProcessingOn() && preparedNumWorkers.load() > 0)
+        channelWorkers.start(preparedNumWorkers.load(), preparedBlockPeriodMs.load());
+    const auto analyzerCapacity = juce::jmax(samplesPerBlock * 2, int(sampleRate * analyzerBufferSeconds));
+    analyzerFifo.prepare(analyzerCapacity);
+    overlayFifo.prepare(analyzerCapacity);
+    analyzerTap.setSize(1, samplesPerBlock);
+
+    preparedSmoothingTime = getSmoothingSeconds();
+    smoother.prepare(sampleRate, preparedSmoothingTime);
+
+    designer.prepare(sampleRate);
+    if (auto* chainCoefficients = designer.getNewCoefficients())
+    {
+        activeOversamplingFactor = chainCoefficients->oversamplingFactor;
+        updateFilters(*chainCoefficients, true);
+        smoother.setTargets(chainCoefficients->settings);
+        smoother.snapToTargets();
+        smoothedCoefficients = *chainCoefficients;
+    }
+
+    if (auto* kernel = linearPhaseDesigner.getNewKernel())
+        getConvolver().setKernel(*kernel);
 }
 
 void EQAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    preparedNumWorkers.store(0);
+    channelWorkers.stop();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -119,8 +197,8 @@ bool EQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
     juce::ignoreUnused (layouts);
     return true;
   #else
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    //the chain is allocated per layout in prepareToPlay, so any channel count works
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -143,21 +221,104 @@ void EQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::Mid
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    updateFilters();
+    auto rampLength = getSmoothingSeconds();
+    if (rampLength != preparedSmoothingTime)
+    {
+        //changing the ramp length snaps every ramp, so put the filters on their targets too
+        preparedSmoothingTime = rampLength;
+        smoother.prepare(getSampleRate(), rampLength);
+        smoother.snapToTargets();
+        designChainCoefficients(smoothedCoefficients, smoother.getCurrentSettings(), getProcessingSampleRate(), { true, true, true, true });
+        updateFilters(smoothedCoefficients, { true, true, true, true });
+    }
+
+    auto maxOversamplingFactor = getOversamplingFactorForChoice(oversamplingChoice->load());
+    if (maxOversamplingFactor != latencyOversamplingFactor)
+        setOversamplingLatency(maxOversamplingFactor);
+
+    auto linearPhaseLength = getLinearPhaseLength(linearPhaseChoice->load());
+    if (linearPhaseLength != getRequestedLinearPhaseLength())
+        setLinearPhaseLength(linearPhaseLength);
+
+    //each convolver ignores kernels designed for another length
+    if (auto* kernel = linearPhaseDesigner.getNewKernel())
+    {
+        for (auto& convolver : convolvers)
+            convolver.setKernel(*kernel);
+    }
+
+    int fadingOutFactor = 0;
+    if (auto* chainCoefficients = designer.getNewCoefficients())
+    {
+        if (chainCoefficients->oversamplingFactor != activeOversamplingFactor)
+        {
+            fadeChain.copyStateFrom(chain);
+            fadingOutFactor = activeOversamplingFactor;
+            setActiveOversamplingFactor(chainCoefficients->oversamplingFactor);
+            updateFilters(*chainCoefficients, true);
+        }
+        else
+        {
+            updateFilters(*chainCoefficients, false);
+        }
+        smoother.setTargets(chainCoefficients->settings);
+    }
 
     juce::dsp::AudioBlock<float> block(buffer);
+    auto* workers = isParallelProcessingOn() && channelWorkers.getNumWorkers() > 0 ? &channelWorkers : nullptr;
+    chain.setWorkers(workers);
+    fadeChain.setWorkers(workers);
+
+    processPaths(block, fadingOutFactor);
+
+    updateAnalyzerFifos(buffer);
+}
+
+void EQAudioProcessor::updateAnalyzerFifos(const juce::AudioBuffer<float>& buffer)
+{
+    using FVO = juce::FloatVectorOperations;
+
+    const auto numSamples = buffer.getNumSamples();
+    const auto* left = buffer.getReadPointer(0);
+    const auto* right = buffer.getReadPointer(juce::jmin(1, buffer.getNumChannels() - 1));
+    const auto source = AnalyzerSource(juce::roundToInt(analyzerSource->load()));
 
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    switch (source)
+    {
+    case AnalyzerSource::Left:
+        analyzerFifo.update(left, numSamples);
+        return;
+    case AnalyzerSource::Right:
+        analyzerFifo.update(right, numSamples);
+        return;
+    case AnalyzerSource::Overlay:
+        analyzerFifo.update(left, numSamples);
+        overlayFifo.update(right, numSamples);
+        return;
+    case AnalyzerSource::Mono:
+    case AnalyzerSource::Mid:
+    case AnalyzerSource::Side:
+        break;
+    }
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    //matrixed sources go through the tap buffer, a chunk at a time in case the host exceeds the prepared block size
+    auto* tap = analyzerTap.getWritePointer(0);
+    const auto chunkSize = analyzerTap.getNumSamples();
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        const auto num = juce::jmin(chunkSize, numSamples - start);
 
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+        if (source == AnalyzerSource::Side)
+            FVO::subtract(tap, left + start, right + start, num);
+        else
+            FVO::add(tap, left + start, right + start, num);
 
-    leftChannelFifo.update(buffer);
-    rightChannelFifo.update(buffer);
+        if (source != AnalyzerSource::Mono)
+            FVO::multiply(tap, .5f, num);
+
+        analyzerFifo.update(tap, num);
+    }
 }
 
 //==============================================================================
@@ -183,8 +344,9 @@ void EQAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
     if (tree.isValid())
     {
+        //replaceState notifies parameterChanged for every parameter that moved,
+        //so the audio thread picks the new settings up on its next block.
         apvts.replaceState(tree);
-        updateFilters();
     }
 }
 
@@ -210,83 +372,1293 @@ ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
     settings.peak2GainDB = apvts.getRawParameterValue("Peak2 Gain")->load();
     settings.peak2Q = apvts.getRawParameterValue("Peak2 Q")->load();
     settings.peak2Bypass = apvts.getRawParameterValue("Peak2 Bypass")->load() > .5f;
+
+    settings.peakDesign = static_cast<PeakDesign>(apvts.getRawParameterValue("Peak Design")->load());
     
     return settings;
 }
 
-Coefficients makePeak1(const ChainSettings& chainSettings, double sampleRate)
+int getMaxOversamplingFactor(juce::AudioProcessorValueTreeState& apvts)
+{
+    return getOversamplingFactorForChoice(apvts.getRawParameterValue("Oversampling")->load());
+}
+
+int getOversamplingFactorForChoice(float choice)
+{
+    return 1 << juce::jlimit(0, 2, juce::roundToInt(choice));
+}
+
+int getOversamplingFactor(const ChainSettings& chainSettings, double sampleRate, int maxFactor)
+{
+    const auto crampingFrequency = float(sampleRate * crampingRatio);
+
+    //matched peaks don't cramp, so only the RBJ ones count
+    const auto rbjPeaks = chainSettings.peakDesign == PeakDesign::PeakDesign_RBJ;
+    const auto peak1Cramped = rbjPeaks && !chainSettings.peak1Bypass && chainSettings.peak1GainDB != 0.f && chainSettings.peak1Freq > crampingFrequency;
+    const auto peak2Cramped = rbjPeaks && !chainSettings.peak2Bypass && chainSettings.peak2GainDB != 0.f && chainSettings.peak2Freq > crampingFrequency;
+    //a high cut at the top of its range is as good as off
+    const auto highCutCramped = !chainSettings.highCutBypass && chainSettings.highCutFreq < 20000.f && chainSettings.highCutFreq > crampingFrequency;
+
+    return peak1Cramped || peak2Cramped || highCutCramped ? maxFactor : 1;
+}
+
+ChainPositions getBandForParameter(const juce::String& parameterID)
+{
+    if (parameterID.startsWith("LowCut"))
+        return ChainPositions::LowCut;
+    if (parameterID.startsWith("HighCut"))
+        return ChainPositions::HighCut;
+    if (parameterID.startsWith("Peak1"))
+        return ChainPositions::Peak1;
+
+    jassert(parameterID.startsWith("Peak2"));
+    return ChainPositions::Peak2;
+}
+
+bool isBandParameter(const juce::String& parameterID)
+{
+    for (auto* prefix : { "LowCut", "HighCut", "Peak1", "Peak2" })
+    {
+        if (parameterID.startsWith(prefix))
+            return true;
+    }
+    return false;
+}
+
+bool isAnalyzerParameter(const juce::String& parameterID)
+{
+    return parameterID.startsWith("Analyzer");
+}
+
+BiquadCoefficients makePeakBiquad(double sampleRate, float frequency, float Q, float gainDB)
+{
+    //same formulas as juce::dsp::IIR::Coefficients::makePeakFilter
+    const auto A = std::sqrt(juce::Decibels::decibelsToGain((double)gainDB));
+    const auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    const auto alpha = std::sin(omega) / (Q * 2.0);
+    const auto c2 = -2.0 * std::cos(omega);
+    const auto alphaTimesA = alpha * A;
+    const auto alphaOverA = alpha / A;
+    const auto a0 = 1.0 + alphaOverA;
+
+    return { float((1.0 + alphaTimesA) / a0),
+             float(c2 / a0),
+             float((1.0 - alphaTimesA) / a0),
+             float(c2 / a0),
+             float((1.0 - alphaOverA) / a0) };
+}
+
+BiquadCoefficients makeMatchedPeakBiquad(double sampleRate, float frequency, float Q, float gainDB)
+{
+    //M. Vicanek, "Matched Second Order Digital Filters", peaking EQ.
+    //the poles are the impulse invariant ones of the analog bell, the zeros are solved so the magnitude
+    //matches the analog one at DC, at the centre frequency and at Nyquist
+    const auto A = std::sqrt(juce::Decibels::decibelsToGain((double)gainDB));
+    const auto G = A * A;
+    const auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    const auto q = 1.0 / (2.0 * A * Q);
+
+    const auto a1 = q <= 1.0 ? -2.0 * std::exp(-q * omega) * std::cos(std::sqrt(1.0 - q * q) * omega)
+                             : -2.0 * std::exp(-q * omega) * std::cosh(std::sqrt(q * q - 1.0) * omega);
+    const auto a2 = std::exp(-2.0 * q * omega);
+
+    const auto A0 = (1.0 + a1 + a2) * (1.0 + a1 + a2);
+    const auto A1 = (1.0 - a1 + a2) * (1.0 - a1 + a2);
+    const auto A2 = -4.0 * a2;
+
+    const auto phi1 = std::pow(std::sin(omega / 2.0), 2.0);
+    const auto phi0 = 1.0 - phi1;
+    const auto phi2 = 4.0 * phi0 * phi1;
+
+    const auto R1 = (A0 * phi0 + A1 * phi1 + A2 * phi2) * G * G;
+    const auto R2 = (-A0 + A1 + 4.0 * (phi0 - phi1) * A2) * G * G;
+
+    const auto B0 = A0;
+    const auto B2 = (R1 - R2 * phi1 - B0) / (4.0 * phi1 * phi1);
+    const auto B1 = R2 + B0 + 4.0 * (phi1 - phi0) * B2;
+
+    const auto W = 0.5 * (std::sqrt(B0) + std::sqrt(juce::jmax(0.0, B1)));
+    const auto b0 = 0.5 * (W + std::sqrt(juce::jmax(0.0, W * W + B2)));
+    const auto b1 = 0.5 * (std::sqrt(B0) - std::sqrt(juce::jmax(0.0, B1)));
+    const auto b2 = -B2 / (4.0 * b0);
+
+    return { float(b0), float(b1), float(b2), float(a1), float(a2) };
+}
+
+BiquadCoefficients makeHighPassBiquad(double sampleRate, float frequency, float Q)
+{
+    //same formulas as juce::dsp::IIR::Coefficients::makeHighPass
+    const auto n = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / Q;
+    const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return { float(c1),
+             float(c1 * -2.0),
+             float(c1),
+             float(c1 * 2.0 * (nSquared - 1.0)),
+             float(c1 * (1.0 - invQ * n + nSquared)) };
+}
+
+BiquadCoefficients makeLowPassBiquad(double sampleRate, float frequency, float Q)
+{
+    //same formulas as juce::dsp::IIR::Coefficients::makeLowPass
+    const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / Q;
+    const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return { float(c1),
+             float(c1 * 2.0),
+             float(c1),
+             float(c1 * 2.0 * (1.0 - nSquared)),
+             float(c1 * (1.0 - invQ * n + nSquared)) };
+}
+
+static float getButterworthSectionQ(int order, int section)
+{
+    return float(1.0 / (2.0 * std::cos((2.0 * section + 1.0) * juce::MathConstants<double>::pi / (order * 2.0))));
+}
+
+void makeLowCutBiquads(std::array<BiquadCoefficients, 4>& sections, const ChainSettings& chainSettings, double sampleRate)
+{
+    const auto order = 2 * (chainSettings.lowCutSlope + 1);
+    for (int i = 0; i < order / 2; ++i)
+    {
+        sections[i] = makeHighPassBiquad(sampleRate, chainSettings.lowCutFreq,
+                                         getButterworthSectionQ(order, i) * chainSettings.lowCutQ);
+    }
+}
+
+void makeHighCutBiquads(std::array<BiquadCoefficients, 4>& sections, const ChainSettings& chainSettings, double sampleRate)
+{
+    const auto order = 2 * (chainSettings.highCutSlope + 1);
+    for (int i = 0; i < order / 2; ++i)
+    {
+        sections[i] = makeLowPassBiquad(sampleRate, chainSettings.highCutFreq,
+                                        getButterworthSectionQ(order, i) * chainSettings.highCutQ);
+    }
+}
+
+void designChainCoefficients(ChainCoefficients& chainCoefficients,
+                             const ChainSettings& chainSettings,
+                             double sampleRate,
+                             const std::array<bool, NumBands>& bandsToDesign)
+{
+    if (bandsToDesign[ChainPositions::LowCut])
+        makeLowCutBiquads(chainCoefficients.lowCut, chainSettings, sampleRate);
+    const auto makePeak = chainSettings.peakDesign == PeakDesign::PeakDesign_Matched ? &makeMatchedPeakBiquad : &makePeakBiquad;
+
+    if (bandsToDesign[ChainPositions::Peak1])
+        chainCoefficients.peak1 = makePeak(sampleRate, chainSettings.peak1Freq, chainSettings.peak1Q, chainSettings.peak1GainDB);
+    if (bandsToDesign[ChainPositions::Peak2])
+        chainCoefficients.peak2 = makePeak(sampleRate, chainSettings.peak2Freq, chainSettings.peak2Q, chainSettings.peak2GainDB);
+    if (bandsToDesign[ChainPositions::HighCut])
+        makeHighCutBiquads(chainCoefficients.highCut, chainSettings, sampleRate);
+
+    chainCoefficients.settings = chainSettings;
+}
+
+//==============================================================================
+void MagnitudeResponse::prepare(int newNumPoints, double minFrequency, double maxFrequency, double sampleRate)
+{
+    resizeTables(newNumPoints);
+
+    const auto logMin = std::log2(minFrequency);
+    const auto logRange = std::log2(maxFrequency) - logMin;
+
+    for (int i = 0; i < numPoints; ++i)
+        setFrequency(i, std::pow(2.0, double(i) / double(numPoints) * logRange + logMin), sampleRate);
+}
+
+void MagnitudeResponse::prepareLinear(int newNumPoints, double maxFrequency, double sampleRate)
+{
+    resizeTables(newNumPoints);
+
+    for (int i = 0; i < numPoints; ++i)
+        setFrequency(i, double(i) / double(numPoints - 1) * maxFrequency, sampleRate);
+}
+
+void MagnitudeResponse::resizeTables(int newNumPoints)
+{
+    numPoints = newNumPoints;
+
+    for (auto* table : { &cosOmega, &cos2Omega, &sinOmega, &sin2Omega, &numerator, &denominator, &real, &imag })
+        table->resize((size_t)numPoints);
+}
+
+void MagnitudeResponse::setFrequency(int index, double frequency, double sampleRate)
+{
+    auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    cosOmega[index] = std::cos(omega);
+    cos2Omega[index] = std::cos(2.0 * omega);
+    sinOmega[index] = std::sin(omega);
+    sin2Omega[index] = std::sin(2.0 * omega);
+}
+
+void MagnitudeResponse::multiplyBySquaredMagnitude(std::vector<double>& product, double c0, double c1, double c2)
+{
+    using FVO = juce::FloatVectorOperations;
+
+    //|c0 + c1 e^{-jw} + c2 e^{-j2w}|^2
+    FVO::copyWithMultiply(real.data(), cosOmega.data(), c1, numPoints);
+    FVO::addWithMultiply(real.data(), cos2Omega.data(), c2, numPoints);
+    FVO::add(real.data(), c0, numPoints);
+
+    FVO::copyWithMultiply(imag.data(), sinOmega.data(), c1, numPoints);
+    FVO::addWithMultiply(imag.data(), sin2Omega.data(), c2, numPoints);
+
+    FVO::multiply(real.data(), real.data(), numPoints);
+    FVO::addWithMultiply(real.data(), imag.data(), imag.data(), numPoints);
+    FVO::multiply(product.data(), real.data(), numPoints);
+}
+
+void MagnitudeResponse::addSection(const BiquadCoefficients& section)
+{
+    multiplyBySquaredMagnitude(numerator, section.b0, section.b1, section.b2);
+    multiplyBySquaredMagnitude(denominator, 1.0, section.a1, section.a2);
+}
+
+void MagnitudeResponse::addBand(const ChainCoefficients& chainCoefficients, ChainPositions band)
+{
+    const auto& chainSettings = chainCoefficients.settings;
+
+    switch (band)
+    {
+    case ChainPositions::LowCut:
+        if (!chainSettings.lowCutBypass)
+        {
+            for (int i = 0; i <= chainSettings.lowCutSlope; ++i)
+                addSection(chainCoefficients.lowCut[i]);
+        }
+        break;
+    case ChainPositions::Peak1:
+        if (!chainSettings.peak1Bypass)
+            addSection(chainCoefficients.peak1);
+        break;
+    case ChainPositions::Peak2:
+        if (!chainSettings.peak2Bypass)
+            addSection(chainCoefficients.peak2);
+        break;
+    case ChainPositions::HighCut:
+        if (!chainSettings.highCutBypass)
+        {
+            for (int i = 0; i <= chainSettings.highCutSlope; ++i)
+                addSection(chainCoefficients.highCut[i]);
+        }
+        break;
+    }
+}
+
+void MagnitudeResponse::clearProducts()
+{
+    juce::FloatVectorOperations::fill(numerator.data(), 1.0, numPoints);
+    juce::FloatVectorOperations::fill(denominator.data(), 1.0, numPoints);
+}
+
+void MagnitudeResponse::writeDecibels(double* magnitudesDB) const
+{
+    //squared magnitudes, so 10 log10 gives dB. the floor keeps deep stopbands finite
+    for (int i = 0; i < numPoints; ++i)
+        magnitudesDB[i] = 10.0 * std::log10(juce::jmax(numerator[i] / denominator[i], 1.0e-20));
+}
+
+void MagnitudeResponse::process(const ChainCoefficients& chainCoefficients, double* magnitudesDB)
+{
+    clearProducts();
+    for (int band = 0; band < NumBands; ++band)
+        addBand(chainCoefficients, ChainPositions(band));
+    writeDecibels(magnitudesDB);
+}
+
+void MagnitudeResponse::processBand(const ChainCoefficients& chainCoefficients, ChainPositions band, double* magnitudesDB)
+{
+    clearProducts();
+    addBand(chainCoefficients, band);
+    writeDecibels(magnitudesDB);
+}
+
+//==============================================================================
+void ChainSmoother::prepare(double sampleRate, double rampLengthSeconds)
+{
+    for (auto* value : { &lowCutFreq, &lowCutQ, &highCutFreq, &highCutQ, &peak1Freq, &peak1Q, &peak2Freq, &peak2Q })
+        value->reset(sampleRate, rampLengthSeconds);
+
+    peak1GainDB.reset(sampleRate, rampLengthSeconds);
+    peak2GainDB.reset(sampleRate, rampLengthSeconds);
+}
+
+void ChainSmoother::setTargets(const ChainSettings& targets)
+{
+    lowCutFreq.setTargetValue(targets.lowCutFreq);
+    lowCutQ.setTargetValue(targets.lowCutQ);
+    highCutFreq.setTargetValue(targets.highCutFreq);
+    highCutQ.setTargetValue(targets.highCutQ);
+    peak1Freq.setTargetValue(targets.peak1Freq);
+    peak1GainDB.setTargetValue(targets.peak1GainDB);
+    peak1Q.setTargetValue(targets.peak1Q);
+    peak2Freq.setTargetValue(targets.peak2Freq);
+    peak2GainDB.setTargetValue(targets.peak2GainDB);
+    peak2Q.setTargetValue(targets.peak2Q);
+
+    current.lowCutSlope = targets.lowCutSlope;
+    current.highCutSlope = targets.highCutSlope;
+    current.lowCutBypass = targets.lowCutBypass;
+    current.highCutBypass = targets.highCutBypass;
+    current.peak1Bypass = targets.peak1Bypass;
+    current.peak2Bypass = targets.peak2Bypass;
+    current.peakDesign = targets.peakDesign;
+}
+
+void ChainSmoother::snapToTargets()
+{
+    for (auto* value : { &lowCutFreq, &lowCutQ, &highCutFreq, &highCutQ, &peak1Freq, &peak1Q, &peak2Freq, &peak2Q })
+        value->setCurrentAndTargetValue(value->getTargetValue());
+
+    peak1GainDB.setCurrentAndTargetValue(peak1GainDB.getTargetValue());
+    peak2GainDB.setCurrentAndTargetValue(peak2GainDB.getTargetValue());
+
+    advance(0);
+}
+
+bool ChainSmoother::isSmoothing() const
+{
+    auto bands = getSmoothingBands();
+    return bands[ChainPositions::LowCut] || bands[ChainPositions::Peak1] || bands[ChainPositions::Peak2] || bands[ChainPositions::HighCut];
+}
+
+std::array<bool, NumBands> ChainSmoother::getSmoothingBands() const
+{
+    std::array<bool, NumBands> bands{};
+    bands[ChainPositions::LowCut] = lowCutFreq.isSmoothing() || lowCutQ.isSmoothing();
+    bands[ChainPositions::Peak1] = peak1Freq.isSmoothing() || peak1GainDB.isSmoothing() || peak1Q.isSmoothing();
+    bands[ChainPositions::Peak2] = peak2Freq.isSmoothing() || peak2GainDB.isSmoothing() || peak2Q.isSmoothing();
+    bands[ChainPositions::HighCut] = highCutFreq.isSmoothing() || highCutQ.isSmoothing();
+    return bands;
+}
+
+const ChainSettings& ChainSmoother::advance(int numSamples)
+{
+    current.lowCutFreq = lowCutFreq.skip(numSamples);
+    current.lowCutQ = lowCutQ.skip(numSamples);
+    current.highCutFreq = highCutFreq.skip(numSamples);
+    current.highCutQ = highCutQ.skip(numSamples);
+    current.peak1Freq = peak1Freq.skip(numSamples);
+    current.peak1GainDB = peak1GainDB.skip(numSamples);
+    current.peak1Q = peak1Q.skip(numSamples);
+    current.peak2Freq = peak2Freq.skip(numSamples);
+    current.peak2GainDB = peak2GainDB.skip(numSamples);
+    current.peak2Q = peak2Q.skip(numSamples);
+    return current;
+}
+
+//==============================================================================
+void EQAudioProcessor::updatePeak1Filter(const ChainCoefficients& chainCoefficients)
+{
+    const auto& chainSettings = chainCoefficients.settings;
+
+    chain.setSection(CascadeSections::Peak1Section, chainCoefficients.peak1);
+    chain.setSectionEnabled(CascadeSections::Peak1Section, !chainSettings.peak1Bypass);
+}
+
+void EQAudioProcessor::updatePeak2Filter(const ChainCoefficients& chainCoefficients)
+{
+    const auto& chainSettings = chainCoefficients.settings;
+
+    chain.setSection(CascadeSections::Peak2Section, chainCoefficients.peak2);
+    chain.setSectionEnabled(CascadeSections::Peak2Section, !chainSettings.peak2Bypass);
+}
+
+void EQAudioProcessor::updateLowCutFilters(const ChainCoefficients& chainCoefficients)
+{
+    const auto& chainSettings = chainCoefficients.settings;
+
+    updateCutSections(chain, CascadeSections::LowCutSections,
+        chainCoefficients.lowCut, chainSettings.lowCutSlope, chainSettings.lowCutBypass);
+}
+
+void EQAudioProcessor::updateHighCutFilters(const ChainCoefficients& chainCoefficients)
+{
+    const auto& chainSettings = chainCoefficients.settings;
+
+    updateCutSections(chain, CascadeSections::HighCutSections,
+        chainCoefficients.highCut, chainSettings.highCutSlope, chainSettings.highCutBypass);
+}
+
+void EQAudioProcessor::updateFilters(const ChainCoefficients& chainCoefficients, bool updateAll)
+{
+    const auto& versions = chainCoefficients.bandVersions;
+
+    std::array<bool, NumBands> changed{};
+    for (int band = 0; band < NumBands; ++band)
+    {
+        changed[band] = updateAll || versions[band] != appliedBandVersions[band];
+    }
+
+    updateFilters(chainCoefficients, changed);
+    appliedBandVersions = versions;
+}
+
+void EQAudioProcessor::updateFilters(const ChainCoefficients& chainCoefficients, const std::array<bool, NumBands>& bands)
+{
+    if (bands[ChainPositions::LowCut])
+        updateLowCutFilters(chainCoefficients);
+    if (bands[ChainPositions::Peak1])
+        updatePeak1Filter(chainCoefficients);
+    if (bands[ChainPositions::Peak2])
+        updatePeak2Filter(chainCoefficients);
+    if (bands[ChainPositions::HighCut])
+        updateHighCutFilters(chainCoefficients);
+}
+
+void EQAudioProcessor::setOversamplingLatency(int factor)
+{
+    latencyOversamplingFactor = factor;
+
+    const auto latency = factor > 1 ? juce::roundToInt(getOversampler(factor).getLatencyInSamples()) : 0;
+    latencyDelay.setDelay(float(latency));
+    latencyDelay.reset();
+    updateLatency();
+}
+
+void EQAudioProcessor::setLinearPhaseLength(int length)
+{
+    //switched back before the new length took over
+    if (length == getConvolver().getLength())
+    {
+        lengthChangePending = false;
+        return;
+    }
+
+    //the chain has been idle while the FIR played, so it fades in from silence rather than from what it held when it stopped
+    if (length == 0 && getConvolver().getLength() > 0)
+    {
+        chain.reset();
+        latencyDelay.reset();
+        if (activeOversamplingFactor > 1)
+            getOversampler(activeOversamplingFactor).reset();
+    }
+
+    getPendingConvolver().setLength(length);
+    lengthChangePending = true;
+}
+
+int EQAudioProcessor::getPathLatency()
+{
+    if (getConvolver().getLength() > 0)
+        return getConvolver().getLatency();
+    if (latencyOversamplingFactor > 1)
+        return juce::roundToInt(getOversampler(latencyOversamplingFactor).getLatencyInSamples());
+    return 0;
+}
+
+void EQAudioProcessor::updateLatency()
+{
+    //the FIR rings for its full length once its latency has passed
+    tailSamples.store(getConvolver().getLength() > 0 ? getConvolver().getLength() + getConvolver().getLatency() : 0);
+    pendingLatency.store(getPathLatency());
+}
+
+void EQAudioProcessor::timerCallback()
+{
+    const auto latency = pendingLatency.load();
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+
+    updateChannelWorkers();
+}
+
+void EQAudioProcessor::updateChannelWorkers()
+{
+    const auto numWorkers = isParallelProcessingOn() ? preparedNumWorkers.load() : 0;
+    if (numWorkers == channelWorkers.getNumWorkers())
+        return;
+
+    //holds the callback lock, so processBlock can't be inside run() while the threads come and go
+    suspendProcessing(true);
+    if (numWorkers > 0)
+        channelWorkers.start(numWorkers, preparedBlockPeriodMs.load());
+    else
+        channelWorkers.stop();
+    suspendProcessing(false);
+}
+
+void EQAudioProcessor::setActiveOversamplingFactor(int factor)
+{
+    activeOversamplingFactor = factor;
+
+    //whichever path takes over starts from silence instead of state left from the last time it ran.
+    //processBlock fades it in under the old path, so the restart isn't heard
+    if (factor > 1)
+        getOversampler(factor).reset();
+    else
+        latencyDelay.reset();
+
+    //the ramps carry on at the new rate
+    designChainCoefficients(smoothedCoefficients, smoother.getCurrentSettings(), getProcessingSampleRate(), { true, true, true, true });
+    if (smoother.isSmoothing())
+        updateFilters(smoothedCoefficients, smoother.getSmoothingBands());
+}
+
+void EQAudioProcessor::processPaths(juce::dsp::AudioBlock<float>& block, int fadingOutFactor)
+{
+    if (lengthChangePending)
+        processLengthChange(block, fadingOutFactor);
+    else if (getConvolver().getLength() > 0)
+        getConvolver().process(block);
+    else
+        processIIR(block, fadingOutFactor);
+}
+
+void EQAudioProcessor::processLengthChange(juce::dsp::AudioBlock<float>& block, int fadingOutFactor)
+{
+    auto& pending = getPendingConvolver();
+    const auto numSamples = block.getNumSamples();
+
+    for (size_t start = 0; start < numSamples; start += preparedBlockSize)
+    {
+        auto subBlock = block.getSubBlock(start, juce::jmin(preparedBlockSize, numSamples - start));
+        auto pendingBlock = juce::dsp::AudioBlock<float>(lengthChangeBuffer).getSubBlock(0, subBlock.getNumSamples());
+        pendingBlock.copyFrom(subBlock);
+
+        //checked before this chunk runs, so a switch never fades in output that was still coming from the delay
+        const auto pendingIsReady = pending.getLength() == 0 || pending.isReady();
+
+        if (pending.getLength() > 0)
+            pending.process(pendingBlock);
+        else
+            processIIR(pendingBlock, start == 0 ? fadingOutFactor : 0);
+
+        if (getConvolver().getLength() > 0)
+            getConvolver().process(subBlock);
+        else
+            processIIR(subBlock, start == 0 ? fadingOutFactor : 0);
+
+        if (!pendingIsReady)
+            continue;
+
+        for (size_t channel = 0; channel < subBlock.getNumChannels(); ++channel)
+        {
+            auto* samples = subBlock.getChannelPointer(channel);
+            const auto* newSamples = pendingBlock.getChannelPointer(channel);
+
+            for (size_t i = 0; i < subBlock.getNumSamples(); ++i)
+            {
+                const auto gain = float(i) / float(subBlock.getNumSamples());
+                samples[i] += gain * (newSamples[i] - samples[i]);
+            }
+        }
+
+        activeConvolver = 1 - activeConvolver;
+        lengthChangePending = false;
+        updateLatency();
+
+        if (start + subBlock.getNumSamples() < numSamples)
+        {
+            auto rest = block.getSubBlock(start + subBlock.getNumSamples());
+            processPaths(rest, 0);
+        }
+        return;
+    }
+}
+
+void EQAudioProcessor::processIIR(juce::dsp::AudioBlock<float>& block, int fadingOutFactor)
+{
+    if (fadingOutFactor > 0)
+    {
+        //the old path gets a copy of the input, both paths run and the new one is faded in over (at most) a prepared block
+        const auto numSamples = block.getNumSamples();
+        const auto fadeLength = juce::jmin(numSamples, preparedBlockSize);
+        auto fadeBlock = juce::dsp::AudioBlock<float>(fadeBuffer).getSubBlock(0, fadeLength);
+        fadeBlock.copyFrom(block.getSubBlock(0, fadeLength));
+
+        processIIRPath(block, activeOversamplingFactor, chain);
+        processIIRPath(fadeBlock, fadingOutFactor, fadeChain);
+
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            auto* samples = block.getChannelPointer(channel);
+            const auto* oldSamples = fadeBlock.getChannelPointer(channel);
+
+            for (size_t i = 0; i < fadeLength; ++i)
+            {
+                const auto gain = float(i) / float(fadeLength);
+                samples[i] = oldSamples[i] + gain * (samples[i] - oldSamples[i]);
+            }
+        }
+    }
+    else
+    {
+        processIIRPath(block, activeOversamplingFactor, chain);
+    }
+}
+
+void EQAudioProcessor::processIIRPath(juce::dsp::AudioBlock<float>& block, int factor, MultiChannelChain& pathChain)
+{
+    //only the live chain ramps, a chain being faded out keeps the coefficients it had
+    auto processPathChain = [this, &pathChain](juce::dsp::AudioBlock<float>& chainBlock)
+    {
+        if (&pathChain == &chain)
+            processChain(chainBlock);
+        else
+            pathChain.process(chainBlock);
+    };
+
+    if (factor > 1)
+    {
+        //the oversampler's buffers only hold the prepared block size
+        auto& oversampler = getOversampler(factor);
+        for (size_t start = 0; start < block.getNumSamples(); start += preparedBlockSize)
+        {
+            auto subBlock = block.getSubBlock(start, juce::jmin(preparedBlockSize, block.getNumSamples() - start));
+            auto oversampledBlock = oversampler.processSamplesUp(subBlock);
+            processPathChain(oversampledBlock);
+            oversampler.processSamplesDown(subBlock);
+        }
+    }
+    else
+    {
+        processPathChain(block);
+
+        if (latencyOversamplingFactor > 1)
+            latencyDelay.process(juce::dsp::ProcessContextReplacing<float>(block));
+    }
+}
+
+void EQAudioProcessor::processChain(juce::dsp::AudioBlock<float>& block)
+{
+    if (smoother.isSmoothing())
+    {
+        processSmoothed(block);
+    }
+    else
+    {
+        chain.process(block);
+    }
+}
+
+int EQAudioProcessor::getSmoothingInterval() const
+{
+    return 8 << juce::jlimit(0, 4, juce::roundToInt(smoothingIntervalChoice->load()));
+}
+
+void EQAudioProcessor::processSmoothed(juce::dsp::AudioBlock<float>& block)
+{
+    //the interval is in host samples, the block may be oversampled
+    const auto factor = (size_t)activeOversamplingFactor;
+    const auto interval = (size_t)getSmoothingInterval() * factor;
+    const auto numSamples = block.getNumSamples();
+
+    for (size_t start = 0; start < numSamples; start += interval)
+    {
+        auto length = juce::jmin(interval, numSamples - start);
+        auto hostLength = int(length / factor);
+
+        std::array<bool, NumBands> landed{};
+        if (smoother.isSmoothing())
+        {
+            //each sub-block is filtered with the ramp's value at its midpoint, then the ramp moves on to its end
+            auto bands = smoother.getSmoothingBands();
+            auto firstHalf = hostLength / 2;
+            designChainCoefficients(smoothedCoefficients, smoother.advance(firstHalf), getProcessingSampleRate(), bands);
+            updateFilters(smoothedCoefficients, bands);
+            smoother.advance(hostLength - firstHalf);
+
+            auto stillSmoothing = smoother.getSmoothingBands();
+            for (size_t band = 0; band < landed.size(); ++band)
+                landed[band] = bands[band] && !stillSmoothing[band];
+        }
+
+        chain.process(block.getSubBlock(start, length));
+
+        //a band whose ramp ended inside this sub-block still has a midpoint design. put it exactly on its target for what follows
+        if (std::find(landed.begin(), landed.end(), true) != landed.end())
+        {
+            designChainCoefficients(smoothedCoefficients, smoother.getCurrentSettings(), getProcessingSampleRate(), landed);
+            updateFilters(smoothedCoefficients, landed);
+        }
+    }
+}
+
+void EQAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    juce::ignoreUnused(newValue);
+
+    //only atomic increments here, the designers poll for them and do nothing else while no version moved.
+    //a new "Oversampling" choice can move every band to another rate, and a new FIR length needs every band
+    if (parameterID == "Oversampling" || parameterID == "Linear Phase")
+    {
+        for (auto& version : bandVersions)
+            ++version;
+    }
+    else if (parameterID == "Peak Design")
+    {
+        ++bandVersions[ChainPositions::Peak1];
+        ++bandVersions[ChainPositions::Peak2];
+    }
+    else if (isBandParameter(parameterID))
+    {
+        ++bandVersions[getBandForParameter(parameterID)];
+    }
+}
+
+//==============================================================================
+void SIMDChainProcessor::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    jassert(spec.numChannels <= SIMDSample::size());
+
+    //lanes without a channel stay silent, so they only ever need clearing once
+    interleaved = juce::dsp::AudioBlock<SIMDSample>(interleavedData, 1, spec.maximumBlockSize);
+    interleaved.clear();
+
+    cascade.reset();
+}
+
+void SIMDChainProcessor::process(const juce::dsp::AudioBlock<float>& block)
+{
+    //hosts may send more than the prepared block size, so anything larger goes through in chunks
+    const auto maxChunkSize = interleaved.getNumSamples();
+    for (size_t start = 0; start < block.getNumSamples(); start += maxChunkSize)
+        processChunk(block.getSubBlock(start, juce::jmin(maxChunkSize, block.getNumSamples() - start)));
+}
+
+void SIMDChainProcessor::processChunk(const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numChannels = juce::jmin(block.getNumChannels(), SIMDSample::size());
+    const auto numSamples = block.getNumSamples();
+    constexpr auto numLanes = SIMDSample::size();
+
+    auto* lanes = reinterpret_cast<float*>(interleaved.getChannelPointer(0));
+
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        auto* source = block.getChannelPointer(ch);
+        for (size_t i = 0; i < numSamples; ++i)
+            lanes[i * numLanes + ch] = source[i];
+    }
+
+    cascade.process(interleaved.getChannelPointer(0), numSamples);
+
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        auto* dest = block.getChannelPointer(ch);
+        for (size_t i = 0; i < numSamples; ++i)
+            dest[i] = lanes[i * numLanes + ch];
+    }
+}
+
+//==============================================================================
+void MultiChannelChain::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    constexpr auto numLanes = SIMDSample::size();
+    const auto numGroups = (spec.numChannels + numLanes - 1) / numLanes;
+
+    groups.clear();
+    groups.resize(numGroups);
+
+    for (size_t group = 0; group < numGroups; ++group)
+    {
+        auto groupSpec = spec;
+        groupSpec.numChannels = juce::jmin(numLanes, spec.numChannels - group * numLanes);
+        groups[group].prepare(groupSpec);
+
+        for (int index = 0; index < NumCascadeSections; ++index)
+        {
+            groups[group].cascade.setSection(index, sectionCoefficients[index]);
+            groups[group].cascade.setSectionEnabled(index, sectionEnabled[index]);
+        }
+    }
+}
+
+void MultiChannelChain::process(const juce::dsp::AudioBlock<float>& block)
+{
+    constexpr auto numLanes = SIMDSample::size();
+    const auto numGroups = juce::jmin(groups.size(), (block.getNumChannels() + numLanes - 1) / numLanes);
+
+    if (workers != nullptr && numGroups > 1 && numGroups * block.getNumSamples() >= minParallelWork)
+    {
+        parallelBlock = &block;
+        workers->run(int(numGroups), &processGroupTask, this);
+        parallelBlock = nullptr;
+        return;
+    }
+
+    for (size_t group = 0; group < numGroups; ++group)
+        processGroup(block, group);
+}
+
+void MultiChannelChain::processGroup(const juce::dsp::AudioBlock<float>& block, size_t group)
+{
+    constexpr auto numLanes = SIMDSample::size();
+    const auto firstChannel = group * numLanes;
+
+    groups[group].process(block.getSubsetChannelBlock(firstChannel, juce::jmin(numLanes, block.getNumChannels() - firstChannel)));
+}
+
+void MultiChannelChain::processGroupTask(void* chain, int group)
+{
+    auto& self = *static_cast<MultiChannelChain*>(chain);
+    self.processGroup(*self.parallelBlock, size_t(group));
+}
+
+void MultiChannelChain::setSection(int index, const BiquadCoefficients& coefficients)
+{
+    sectionCoefficients[index] = coefficients;
+    for (auto& group : groups)
+        group.cascade.setSection(index, coefficients);
+}
+
+void MultiChannelChain::setSectionEnabled(int index, bool shouldBeEnabled)
+{
+    sectionEnabled[index] = shouldBeEnabled;
+    for (auto& group : groups)
+        group.cascade.setSectionEnabled(index, shouldBeEnabled);
+}
+
+void MultiChannelChain::reset()
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peak1Freq,
-        chainSettings.peak1Q,
-        juce::Decibels::decibelsToGain(chainSettings.peak1GainDB));
+    for (auto& group : groups)
+        group.cascade.reset();
 }
-Coefficients makePeak2( const ChainSettings& chainSettings, double sampleRate)
+
+void MultiChannelChain::copyStateFrom(const MultiChannelChain& other)
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peak2Freq,
-        chainSettings.peak2Q,
-        juce::Decibels::decibelsToGain(chainSettings.peak2GainDB));
+    jassert(groups.size() == other.groups.size());
+
+    sectionCoefficients = other.sectionCoefficients;
+    sectionEnabled = other.sectionEnabled;
+    for (size_t group = 0; group < juce::jmin(groups.size(), other.groups.size()); ++group)
+        groups[group].cascade = other.groups[group].cascade;
 }
 
-void EQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings)
+//==============================================================================
+void ChannelGroupWorkers::start(int numWorkersToUse, double blockPeriodMs)
 {
-    auto peak1Coefficients = makePeak1(chainSettings, getSampleRate());
+    stop();
+    spinMilliseconds = 1.5 * blockPeriodMs;
 
-    leftChain.setBypassed<ChainPositions::Peak1>(chainSettings.peak1Bypass);
-    rightChain.setBypassed<ChainPositions::Peak1>(chainSettings.peak1Bypass);
+    for (int i = 0; i < numWorkersToUse; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>(*this));
+        workers.back()->startRealtimeThread(juce::Thread::RealtimeOptions{}.withPeriodMs(blockPeriodMs));
+    }
+}
 
-    updateCoefficients(leftChain.get<ChainPositions::Peak1>().coefficients, peak1Coefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak1>().coefficients, peak1Coefficients);
+void ChannelGroupWorkers::stop()
+{
+    for (auto& worker : workers)
+    {
+        worker->signalThreadShouldExit();
+        worker->notify();
+    }
 
-    auto peak2Coefficients = makePeak2(chainSettings, getSampleRate());
+    for (auto& worker : workers)
+        worker->stopThread(1000);
 
-    leftChain.setBypassed<ChainPositions::Peak2>(chainSettings.peak2Bypass);
-    rightChain.setBypassed<ChainPositions::Peak2>(chainSettings.peak2Bypass);
-    updateCoefficients(leftChain.get<ChainPositions::Peak2>().coefficients, peak2Coefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak2>().coefficients, peak2Coefficients);
+    workers.clear();
 }
 
-void updateCoefficients(Coefficients& old, const Coefficients& replacements)
+void ChannelGroupWorkers::run(int numTasksToRun, Task taskToRun, void* taskContext)
 {
-    *old = *replacements;
+    jassert(numTasksToRun <= 0xffff);
+
+    //the previous run's tasks have all finished, so nobody reads these until the new word is published
+    task = taskToRun;
+    context = taskContext;
+    numTasksFinished.store(0);
+
+    const auto generation = getGeneration(claims.load()) + 1;
+    claims.store((juce::uint64(generation) << 32) | (juce::uint64(numTasksToRun) << 16));
+
+    runTasks(generation);
+
+    //only the tasks still running on a worker are waited for, not the workers themselves
+    while (numTasksFinished.load() < numTasksToRun) {}
 }
 
-void EQAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings)
+void ChannelGroupWorkers::runTasks(juce::uint32 generationToRun)
 {
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
+    auto word = claims.load();
 
-    leftChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypass);
-    rightChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypass);
+    for (;;)
+    {
+        const auto numTasks = int((word >> 16) & 0xffff);
+        const auto index = int(word & 0xffff);
+        if (getGeneration(word) != generationToRun || index >= numTasks)
+            return;
 
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    updateCutFilter(leftLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
+        if (!claims.compare_exchange_weak(word, word + 1))
+            continue;
 
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
-    updateCutFilter(rightLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
+        task(context, index);
+        numTasksFinished.fetch_add(1);
+        word = claims.load();
+    }
 }
 
-void EQAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings)
+void ChannelGroupWorkers::Worker::run()
 {
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
+    //the filters run here as well as on the audio thread, so they need the same protection from denormals
+    juce::FloatVectorOperations::disableDenormalisedNumberSupport();
 
-    leftChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypass);
-    rightChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypass);
+    while (!threadShouldExit())
+    {
+        const auto spinEnd = juce::Time::getMillisecondCounterHiRes() + owner.spinMilliseconds;
+        while (getGeneration(owner.claims.load()) == seenGeneration
+               && juce::Time::getMillisecondCounterHiRes() < spinEnd
+               && !threadShouldExit()) {}
+
+        //nothing wakes a parked worker, so the audio thread never touches its event
+        if (getGeneration(owner.claims.load()) == seenGeneration)
+        {
+            wait(parkedPollMs);
+            continue;
+        }
+
+        seenGeneration = getGeneration(owner.claims.load());
+        owner.runTasks(seenGeneration);
+    }
+}
 
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
+//==============================================================================
+CoefficientDesigner::CoefficientDesigner(juce::AudioProcessorValueTreeState& apvts,
+                                         const std::array<juce::Atomic<int>, NumBands>& bandVersions,
+                                         LinearPhaseDesigner& linearPhaseDesigner) :
+    juce::Thread("EQ Coefficient Designer"),
+    apvts(apvts),
+    bandVersions(bandVersions),
+    linearPhaseDesigner(linearPhaseDesigner)
+{
+}
 
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
-    updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
+CoefficientDesigner::~CoefficientDesigner()
+{
+    stopThread(1000);
 }
 
-void EQAudioProcessor::updateFilters()
+void CoefficientDesigner::prepare(double newSampleRate)
 {
+    {
+        const juce::ScopedLock sl(designLock);
+        sampleRate = newSampleRate;
+        designChangedBands(true);
+        linearPhaseDesigner.prepare(newSampleRate);
+    }
+
+    if (!isThreadRunning())
+        startThread();
+}
+
+const ChainCoefficients* CoefficientDesigner::getNewCoefficients()
+{
+    return snapshots.acquire() ? &snapshots.getReadBuffer() : nullptr;
+}
+
+void CoefficientDesigner::run()
+{
+    while (!threadShouldExit())
+    {
+        //nothing wakes us, the versions are polled
+        wait(pollIntervalMs);
+
+        const juce::ScopedLock sl(designLock);
+        designChangedBands(false);
+        linearPhaseDesigner.designChangedKernel();
+    }
+}
+
+void CoefficientDesigner::designChangedBands(bool designAll)
+{
+    if (sampleRate <= 0.0)
+        return;
+
+    //read the versions before the settings so a change that lands in between gets designed again next pass.
+    //every parameter the design depends on bumps a version, so an idle poll stops here without touching the APVTS
+    std::array<bool, NumBands> changed{};
+    bool anyChanged = designAll;
+
+    for (int band = 0; band < NumBands; ++band)
+    {
+        auto version = bandVersions[band].get();
+        if (designAll || version != designedBandVersions[band])
+        {
+            designedBandVersions[band] = version;
+            changed[band] = true;
+            anyChanged = true;
+        }
+    }
+
+    if (!anyChanged)
+        return;
+
+    //a band crossing into the cramping region, or a new "Oversampling" choice, moves every band to the new rate
     auto chainSettings = getChainSettings(apvts);
-    updatePeakFilter(chainSettings);
-    updateLowCutFilters(chainSettings);
-    updateHighCutFilters(chainSettings);
+    auto oversamplingFactor = getOversamplingFactor(chainSettings, sampleRate, getMaxOversamplingFactor(apvts));
+    if (oversamplingFactor != designedOversamplingFactor)
+    {
+        designedOversamplingFactor = oversamplingFactor;
+        changed = { true, true, true, true };
+    }
+
+    designChainCoefficients(designed, chainSettings, sampleRate * oversamplingFactor, changed);
+    designed.bandVersions = designedBandVersions;
+    designed.oversamplingFactor = oversamplingFactor;
+
+    snapshots.getWriteBuffer() = designed;
+    snapshots.publish();
+}
+
+//==============================================================================
+int getLinearPhaseLength(float choice)
+{
+    static constexpr int lengths[] = { 0, 4096, 8192, maxLinearPhaseLength };
+    return lengths[juce::jlimit(0, 3, juce::roundToInt(choice))];
+}
+
+void PartitionedConvolver::prepare(int newNumChannels, int maxKernelLength)
+{
+    numChannels = newNumChannels;
+    maxPartitions = maxKernelLength / partitionSize;
+
+    for (auto& kernel : kernels)
+        kernel.assign(size_t(maxPartitions * numBins), {});
+
+    delayLines.assign(size_t(numChannels * maxPartitions * numBins), {});
+    inputs.setSize(numChannels, 2 * partitionSize);
+    outputs.setSize(numChannels, partitionSize);
+
+    fftBuffer.assign(size_t(4 * partitionSize), 0.f);
+    accumulator.assign(size_t(numBins), {});
+    crossfadeBuffer.assign(size_t(partitionSize), 0.f);
+
+    length = -1;
+    setLength(0);
+}
+
+void PartitionedConvolver::setLength(int newLength)
+{
+    jassert(newLength % (2 * partitionSize) == 0 && newLength / partitionSize <= maxPartitions);
+
+    length = newLength;
+    numPartitions = length / partitionSize;
+
+    std::fill(delayLines.begin(), delayLines.end(), std::complex<float>());
+    delayLineIndex = 0;
+    inputs.clear();
+    outputs.clear();
+    fifoPosition = 0;
+    crossfading = false;
+    kernelLoaded = ready = false;
+
+    //a unit impulse at the centre tap: the partition holding it has a flat spectrum, every other one is silent
+    auto& kernel = kernels[activeKernel];
+    std::fill(kernel.begin(), kernel.end(), std::complex<float>());
+    if (numPartitions > 0)
+    {
+        auto centrePartition = kernel.begin() + (numPartitions / 2) * numBins;
+        std::fill(centrePartition, centrePartition + numBins, std::complex<float>(1.f, 0.f));
+    }
+}
+
+void PartitionedConvolver::setKernel(const LinearPhaseKernel& kernel)
+{
+    if (kernel.length != length || length == 0)
+        return;
+
+    std::copy(kernel.partitions.begin(), kernel.partitions.end(), kernels[1 - activeKernel].begin());
+    crossfading = true;
+}
+
+void PartitionedConvolver::process(const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numSamples = int(block.getNumSamples());
+    const auto channelsToProcess = juce::jmin(int(block.getNumChannels()), numChannels);
+
+    for (int start = 0; start < numSamples;)
+    {
+        const auto num = juce::jmin(partitionSize - fifoPosition, numSamples - start);
+
+        for (int ch = 0; ch < channelsToProcess; ++ch)
+        {
+            auto* samples = block.getChannelPointer(size_t(ch)) + start;
+            juce::FloatVectorOperations::copy(inputs.getWritePointer(ch, partitionSize + fifoPosition), samples, num);
+            juce::FloatVectorOperations::copy(samples, outputs.getReadPointer(ch, fifoPosition), num);
+        }
+
+        fifoPosition += num;
+        start += num;
+
+        if (fifoPosition == partitionSize)
+        {
+            processPartition();
+            fifoPosition = 0;
+        }
+    }
 }
 
+void PartitionedConvolver::processPartition()
+{
+    using FVO = juce::FloatVectorOperations;
+    auto* spectrum = reinterpret_cast<std::complex<float>*>(fftBuffer.data());
+
+    //this partition's output still ramps from the delay if the first kernel is only coming in now
+    ready = kernelLoaded;
 
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* input = inputs.getWritePointer(ch);
+        auto* output = outputs.getWritePointer(ch);
+        auto* delayLine = delayLines.data() + ch * maxPartitions * numBins;
+
+        //overlap-save: transform the previous and the current partition together
+        FVO::copy(fftBuffer.data(), input, 2 * partitionSize);
+        FVO::clear(fftBuffer.data() + 2 * partitionSize, 2 * partitionSize);
+        fft.performRealOnlyForwardTransform(fftBuffer.data(), true);
+        std::copy(spectrum, spectrum + numBins, delayLine + delayLineIndex * numBins);
+
+        convolve(kernels[activeKernel], delayLine, output);
+
+        if (crossfading)
+        {
+            convolve(kernels[1 - activeKernel], delayLine, crossfadeBuffer.data());
+
+            for (int i = 0; i < partitionSize; ++i)
+            {
+                const auto ramp = float(i) / float(partitionSize);
+                output[i] += ramp * (crossfadeBuffer[i] - output[i]);
+            }
+        }
+
+        FVO::copy(input, input + partitionSize, partitionSize);
+    }
+
+    if (crossfading)
+    {
+        activeKernel = 1 - activeKernel;
+        crossfading = false;
+        kernelLoaded = true;
+    }
+
+    delayLineIndex = (delayLineIndex + 1) % numPartitions;
+}
+
+void PartitionedConvolver::convolve(const std::vector<std::complex<float>>& kernel, const std::complex<float>* delayLine, float* output)
+{
+    std::fill(accumulator.begin(), accumulator.end(), std::complex<float>());
+
+    //the newest input spectrum pairs with the first kernel partition, the oldest with the last
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        const auto* x = delayLine + ((delayLineIndex - partition + numPartitions) % numPartitions) * numBins;
+        const auto* h = kernel.data() + partition * numBins;
+
+        for (int bin = 0; bin < numBins; ++bin)
+            accumulator[bin] += x[bin] * h[bin];
+    }
+
+    auto* spectrum = reinterpret_cast<std::complex<float>*>(fftBuffer.data());
+    std::copy(accumulator.begin(), accumulator.end(), spectrum);
+    std::fill(spectrum + numBins, spectrum + 2 * partitionSize, std::complex<float>());
+    fft.performRealOnlyInverseTransform(fftBuffer.data());
+
+    //the first half wrapped around, the second half is the partition's output
+    juce::FloatVectorOperations::copy(output, fftBuffer.data() + partitionSize, partitionSize);
+}
+
+//==============================================================================
+LinearPhaseDesigner::LinearPhaseDesigner(juce::AudioProcessorValueTreeState& apvts,
+                                         const std::array<juce::Atomic<int>, NumBands>& bandVersions) :
+    apvts(apvts),
+    bandVersions(bandVersions)
+{
+    linearPhaseChoice = apvts.getRawParameterValue("Linear Phase");
+    partitionBuffer.resize(4 * PartitionedConvolver::partitionSize);
+}
+
+void LinearPhaseDesigner::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    designKernel(true);
+}
+
+const LinearPhaseKernel* LinearPhaseDesigner::getNewKernel()
+{
+    return kernels.acquire() ? &kernels.getReadBuffer() : nullptr;
+}
+
+void LinearPhaseDesigner::designKernel(bool designAnyway)
+{
+    constexpr auto partitionSize = PartitionedConvolver::partitionSize;
+    constexpr auto numBins = PartitionedConvolver::numBins;
+
+    if (sampleRate <= 0.0)
+        return;
+
+    //"Linear Phase" and "Oversampling" bump every version too, so unchanged versions mean an unchanged kernel
+    std::array<int, NumBands> versions;
+    for (int band = 0; band < NumBands; ++band)
+        versions[band] = bandVersions[band].get();
+
+    if (!designAnyway && versions == designedBandVersions)
+        return;
+
+    designedBandVersions = versions;
+
+    const auto length = getLinearPhaseLength(linearPhaseChoice->load());
+    if (length == 0)
+        return;
+
+    //the same rate the response curve is designed at, so the FIR follows the curve on screen
+    const auto maxOversamplingFactor = getMaxOversamplingFactor(apvts);
+    const auto chainSettings = getChainSettings(apvts);
+    const auto designRate = sampleRate * getOversamplingFactor(chainSettings, sampleRate, maxOversamplingFactor);
+    designChainCoefficients(coefficients, chainSettings, designRate, { true, true, true, true });
+
+    const auto numPoints = length / 2 + 1;
+    if (magnitudeResponse.getNumPoints() != numPoints || magnitudeResponseRate != designRate)
+    {
+        magnitudeResponse.prepareLinear(numPoints, sampleRate / 2.0, designRate);
+        magnitudeResponseRate = designRate;
+        magnitudesDB.resize(size_t(numPoints));
+    }
+
+    if (impulseFFT == nullptr || impulseFFT->getSize() != length)
+    {
+        impulseFFT = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(length)));
+        impulse.resize(size_t(2 * length));
+    }
+
+    //zero phase spectrum, so the inverse transform is an impulse centred on sample 0
+    magnitudeResponse.process(coefficients, magnitudesDB.data());
+    std::fill(impulse.begin(), impulse.end(), 0.f);
+    for (int bin = 0; bin < numPoints; ++bin)
+        impulse[size_t(2 * bin)] = float(juce::Decibels::decibelsToGain(magnitudesDB[size_t(bin)], -400.0));
+
+    impulseFFT->performRealOnlyInverseTransform(impulse.data());
+
+    auto& kernel = kernels.getWriteBuffer();
+    kernel.length = length;
+    kernel.partitions.resize(size_t(length / partitionSize * numBins));
+
+    for (int partition = 0; partition < length / partitionSize; ++partition)
+    {
+        //centred on length / 2 and shaped by a periodic Hann window, which keeps the taps exactly symmetric
+        for (int i = 0; i < partitionSize; ++i)
+        {
+            const auto n = partition * partitionSize + i;
+            const auto window = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * n / length);
+            partitionBuffer[size_t(i)] = float(impulse[size_t((n + length / 2) % length)] * window);
+        }
+
+        std::fill(partitionBuffer.begin() + partitionSize, partitionBuffer.end(), 0.f);
+        partitionFFT.performRealOnlyForwardTransform(partitionBuffer.data(), true);
+
+        const auto* spectrum = reinterpret_cast<const std::complex<float>*>(partitionBuffer.data());
+        std::copy(spectrum, spectrum + numBins, kernel.partitions.begin() + partition * numBins);
+    }
+
+    kernels.publish();
+}
 
 juce::AudioProcessorValueTreeState::ParameterLayout 
 EQAudioProcessor::createParameterLayout()
@@ -352,6 +1724,41 @@ EQAudioProcessor::createParameterLayout()
 
     layout.add(std::make_unique < juce::AudioParameterBool>
         ("Peak2 Bypass", "Peak2 Bypass", false));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>
+        ("Peak Design", "Peak Design", juce::StringArray{ "RBJ", "Matched" }, 0));
+
+
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>
+        ("Oversampling", "Oversampling", juce::StringArray{ "Off", "2x", "4x" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>
+        ("Linear Phase", "Linear Phase", juce::StringArray{ "Off", "4096 taps", "8192 taps", "16384 taps" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>
+        ("Smoothing Time", "Smoothing Time (ms)", juce::NormalisableRange<float>(0.f, 500.f, 1.f, .5f), 50.f));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>
+        ("Smoothing Interval", "Smoothing Interval", juce::StringArray{ "8", "16", "32", "64", "128" }, 2));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>
+        ("Parallel Processing", "Parallel Processing", false));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>
+        ("Analyzer Order", "Analyzer Order", juce::StringArray{ "2048", "4096", "8192" }, 1));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>
+        ("Analyzer Overlap", "Analyzer Overlap", juce::StringArray{ "50%", "75%", "87.5%" }, 1));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>
+        ("Analyzer Source", "Analyzer Source", juce::StringArray{ "Left", "Right", "Mono (L+R)", "Mid", "Side", "L/R Overlay" }, 5));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>
+        ("Analyzer Mode", "Analyzer Mode", juce::StringArray{ "Realtime", "Average", "Peak Hold", "Infinite Max" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>
+        ("Analyzer Decay", "Analyzer Decay", juce::StringArray{ "3 dB/s", "6 dB/s", "12 dB/s", "24 dB/s", "48 dB/s" }, 2));
     return layout;
 }
 
@@ -73,73 +73,143 @@ private:
     juce::AbstractFifo fifo{ Capacity };
 };
 
-enum Channel
+/**
+ single-writer / single-reader triple buffer.
+ the writer fills getWriteBuffer() and publishes it, the reader swaps in the newest
+ published buffer with acquire(). neither side ever blocks or allocates, and a
+ buffer is never touched by both sides at once.
+ */
+template<typename T>
+struct TripleBuffer
+{
+    T& getWriteBuffer() { return buffers[backIndex]; }
+
+    void publish()
+    {
+        backIndex = middleIndex.exchange(backIndex | freshFlag) & indexMask;
+    }
+
+    bool acquire()
+    {
+        if ((middleIndex.load() & freshFlag) == 0)
+            return false;
+
+        frontIndex = middleIndex.exchange(frontIndex) & indexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const { return buffers[frontIndex]; }
+private:
+    static constexpr int freshFlag = 4;
+    static constexpr int indexMask = 3;
+
+    std::array<T, 3> buffers;
+    std::atomic<int> middleIndex{ 1 };
+    int backIndex = 0;  //owned by the writer
+    int frontIndex = 2; //owned by the reader
+};
+
+/**
+ what the analyzer shows. the processor matrixes the chosen signal at the tap, so only the spectra
+ that are displayed are ever transformed: one for every source except Overlay, which needs two.
+ */
+enum AnalyzerSource
+{
+    Left,
+    Right,
+    Mono,
+    Mid,
+    Side,
+    Overlay
+};
+
+/**
+ a contiguous run of samples owned by someone else.
+ */
+struct SampleSpan
 {
-    Right, Left
+    const float* data = nullptr;
+    int size = 0;
 };
 
+/**
+ lock-free single-producer / single-consumer ring of analyzer samples.
+ the audio thread copies each block in with at most two bulk copies, and the analyzer
+ reads the waiting samples in place through a pair of spans instead of copying them out.
+ */
 template<typename BlockType>
 struct SingleChannelSampleFifo
 {
-    SingleChannelSampleFifo(Channel ch) : channelToUse(ch)
+    SingleChannelSampleFifo()
     {
         prepared.set(false);
     }
 
-    void update(const BlockType & buffer)
+    void update(const float* channelPtr, int numSamples)
     {
         jassert(prepared.get());
-        jassert(buffer.getNumChannels() > channelToUse);
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
 
-        for (int i = 0; i < buffer.getNumSamples(); ++i)
-        {
-            pushNextSampleIntoFifo(channelPtr[i]);
-        }
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+        //whatever doesn't fit is dropped, the analyzer has fallen behind
+        if (size1 + size2 < numSamples)
+            droppedSamples += numSamples - (size1 + size2);
+
+        auto* ring = samples.getWritePointer(0);
+        if (size1 > 0)
+            juce::FloatVectorOperations::copy(ring + start1, channelPtr, size1);
+        if (size2 > 0)
+            juce::FloatVectorOperations::copy(ring + start2, channelPtr + size1, size2);
+
+        fifo.finishedWrite(size1 + size2);
     }
 
-    void prepare(int bufferSize)
+    /**
+     'capacity' is how many samples the analyzer can fall behind by. it has nothing to do with the host block size.
+     */
+    void prepare(int capacity)
     {
         prepared.set(false);
-        size.set(bufferSize);
-
-        bufferToFill.setSize(1,             //channel
-                             bufferSize,    //num samples
-                             false,         //keepExistingContent
-                             true,          //clear extra space
-                             true);         //avoid reallocating
-        audioBufferFifo.prepare(1, bufferSize);
-        fifoIndex = 0;
+        size.set(capacity);
+
+        //AbstractFifo keeps one slot free, so it indexes one sample more than it will ever hold
+        samples.setSize(1,             //channel
+                        capacity + 1,  //num samples
+                        false,         //keepExistingContent
+                        true,          //clear extra space
+                        true);         //avoid reallocating
+        samples.clear();
+        fifo.setTotalSize(capacity + 1);
+        droppedSamples.set(0);
         prepared.set(true);
     }
     //==============================================================================
-    int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
+    int getNumSamplesAvailable() const { return fifo.getNumReady(); }
     bool isPrepared() const { return prepared.get(); }
     int getSize() const { return size.get(); }
+    int getNumDroppedSamples() const { return droppedSamples.get(); }
     //==============================================================================
-    bool getAudioBuffer(BlockType & buf) { return audioBufferFifo.pull(buf); }
-private:
-    Channel channelToUse;
-    int fifoIndex = 0;
-    Fifo<BlockType> audioBufferFifo;
-    BlockType bufferToFill;
-    juce::Atomic<bool> prepared = false;
-    juce::Atomic<int> size = 0;
-
-    void pushNextSampleIntoFifo(float sample)
+    /**
+     the next 'numSamples' waiting samples, in order. the second span is only used when they wrap around the ring.
+     they stay valid until finishedRead() is called.
+     */
+    std::pair<SampleSpan, SampleSpan> getSamples(int numSamples) const
     {
-        if (fifoIndex == bufferToFill.getNumSamples())
-        {
-            auto ok = audioBufferFifo.push(bufferToFill);
-
-            juce::ignoreUnused(ok);
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(numSamples, start1, size1, start2, size2);
 
-            fifoIndex = 0;
-        }
-
-        bufferToFill.setSample(0, fifoIndex, sample);
-        ++fifoIndex;
+        auto* ring = samples.getReadPointer(0);
+        return { { ring + start1, size1 }, { ring + start2, size2 } };
     }
+
+    void finishedRead(int numSamples) { fifo.finishedRead(numSamples); }
+private:
+    juce::AudioBuffer<float> samples;
+    juce::AbstractFifo fifo{ 1 };
+    juce::Atomic<bool> prepared = false;
+    juce::Atomic<int> size = 0;
+    juce::Atomic<int> droppedSamples = 0;
 };
 
 enum Slope
@@ -150,6 +220,16 @@ enum Slope
     Slope_48
 };
 
+/**
+ how the peak bands are designed. RBJ is the bilinear transform of the analog bell, which cramps towards Nyquist.
+ Matched follows Vicanek's matched second order design, which keeps the analog magnitude up to Nyquist at no extra cost per sample.
+ */
+enum PeakDesign
+{
+    PeakDesign_RBJ,
+    PeakDesign_Matched
+};
+
 struct ChainSettings
 {
     float peak1Freq{ 0 }, peak1GainDB{ 0 }, peak1Q{ 1.f };
@@ -162,15 +242,33 @@ struct ChainSettings
     Slope lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
 
     bool lowCutBypass{ false }, highCutBypass{ false }, peak1Bypass{ false }, peak2Bypass{ false };
+
+    PeakDesign peakDesign{ PeakDesign::PeakDesign_RBJ };
 };
 
-using Filter = juce::dsp::IIR::Filter<float>;
+inline bool operator==(const ChainSettings& lhs, const ChainSettings& rhs)
+{
+    auto tie = [](const ChainSettings& s)
+    {
+        return std::tie(s.peak1Freq, s.peak1GainDB, s.peak1Q, s.peak2Freq, s.peak2GainDB, s.peak2Q,
+                        s.lowCutFreq, s.lowCutQ, s.highCutFreq, s.highCutQ, s.lowCutSlope, s.highCutSlope,
+                        s.lowCutBypass, s.highCutBypass, s.peak1Bypass, s.peak2Bypass, s.peakDesign);
+    };
+    return tie(lhs) == tie(rhs);
+}
 
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
 
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, Filter, CutFilter>;
+/** the factor picked by the "Oversampling" parameter: 1, 2 or 4. */
+int getMaxOversamplingFactor(juce::AudioProcessorValueTreeState& apvts);
+int getOversamplingFactorForChoice(float choice);
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+/**
+ the bilinear transform cramps the RBJ peaks and the high cut as they approach Nyquist. once an active one of them
+ sits above crampingRatio * sampleRate this returns 'maxFactor', otherwise 1, so the chain only runs oversampled when it helps.
+ */
+static constexpr double crampingRatio = 0.2;
+int getOversamplingFactor(const ChainSettings& chainSettings, double sampleRate, int maxFactor);
 
 enum ChainPositions
 {
@@ -180,58 +278,565 @@ enum ChainPositions
     HighCut
 };
 
-using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
+static constexpr int NumBands = 4;
+
+/**
+ maps a parameter ID like "Peak1 Freq" onto the band it belongs to.
+ */
+ChainPositions getBandForParameter(const juce::String& parameterID);
+
+/** true for the parameters of a single band, the ones getBandForParameter can map. */
+bool isBandParameter(const juce::String& parameterID);
+
+/**
+ the analyzer's settings are parameters too, so hosts can store and automate them, but they never touch the audio.
+ */
+bool isAnalyzerParameter(const juce::String& parameterID);
+
+/**
+ normalised second order section, laid out the same way juce::dsp::IIR::Coefficients stores them.
+ */
+struct BiquadCoefficients
+{
+    float b0{ 1.f }, b1{ 0.f }, b2{ 0.f }, a1{ 0.f }, a2{ 0.f };
+};
+
+/**
+ a complete set of designed sections for one channel of the chain, plus the settings and band versions they came from.
+ */
+struct ChainCoefficients
+{
+    ChainSettings settings;
+    std::array<BiquadCoefficients, 4> lowCut, highCut;
+    BiquadCoefficients peak1, peak2;
+    std::array<int, NumBands> bandVersions{};
+
+    //the sections are designed for the host's sample rate times this
+    int oversamplingFactor{ 1 };
+};
+
+/**
+ closed-form versions of the JUCE filter factories. they return plain sections instead of
+ heap-allocated Coefficients, so they are cheap enough to call on the audio thread while smoothing.
+ */
+BiquadCoefficients makePeakBiquad(double sampleRate, float frequency, float Q, float gainDB);
+BiquadCoefficients makeMatchedPeakBiquad(double sampleRate, float frequency, float Q, float gainDB);
+BiquadCoefficients makeHighPassBiquad(double sampleRate, float frequency, float Q);
+BiquadCoefficients makeLowPassBiquad(double sampleRate, float frequency, float Q);
+
+/**
+ Butterworth cascades of 2 * (slope + 1) order. each section's Q is scaled by the band's Q control.
+ */
+void makeLowCutBiquads(std::array<BiquadCoefficients, 4>& sections, const ChainSettings& chainSettings, double sampleRate);
+void makeHighCutBiquads(std::array<BiquadCoefficients, 4>& sections, const ChainSettings& chainSettings, double sampleRate);
 
-Coefficients makePeak1(const ChainSettings& chainSettings, double sampleRate);
-Coefficients makePeak2(const ChainSettings& chainSettings, double sampleRate);
+/**
+ redesigns the flagged bands of 'chainCoefficients' from 'chainSettings' and takes over the settings.
+ */
+void designChainCoefficients(ChainCoefficients& chainCoefficients,
+                             const ChainSettings& chainSettings,
+                             double sampleRate,
+                             const std::array<bool, NumBands>& bandsToDesign);
 
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, const CoefficientType& coefficients)
+/**
+ evaluates the magnitude response of a ChainCoefficients at a fixed set of frequencies.
+ e^{-jw} and e^{-j2w} are tabulated once per frequency set, after which every section costs a handful
+ of FloatVectorOperations passes over the whole table instead of per-frequency complex arithmetic.
+ */
+struct MagnitudeResponse
 {
-    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-    chain.template setBypassed<Index>(false);
-}
+    /** lays out 'numPoints' frequencies logarithmically from minFrequency up to (but not including) maxFrequency. */
+    void prepare(int numPoints, double minFrequency, double maxFrequency, double sampleRate);
+
+    /** lays out 'numPoints' frequencies linearly from DC up to and including maxFrequency, e.g. the bins of an FFT. */
+    void prepareLinear(int numPoints, double maxFrequency, double sampleRate);
+    int getNumPoints() const { return numPoints; }
 
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& leftLowCut,
-    const CoefficientType& cutCoefficients,
-    const Slope& lowCutSlope)
+    /** writes the combined response of every active section in dB, one value per prepared frequency. */
+    void process(const ChainCoefficients& chainCoefficients, double* magnitudesDB);
+
+    /** same as process, but only for the sections of one band. */
+    void processBand(const ChainCoefficients& chainCoefficients, ChainPositions band, double* magnitudesDB);
+private:
+    int numPoints = 0;
+    std::vector<double> cosOmega, cos2Omega, sinOmega, sin2Omega;
+    std::vector<double> numerator, denominator, real, imag;
+
+    void resizeTables(int newNumPoints);
+    void setFrequency(int index, double frequency, double sampleRate);
+    void clearProducts();
+    void addBand(const ChainCoefficients& chainCoefficients, ChainPositions band);
+    void addSection(const BiquadCoefficients& section);
+    void writeDecibels(double* magnitudesDB) const;
+    void multiplyBySquaredMagnitude(std::vector<double>& product, double c0, double c1, double c2);
+};
+
+/**
+ ramps the continuous ChainSettings values towards their targets.
+ frequencies and Qs move in the log domain, gains move linearly in dB.
+ slopes and bypass states are discrete and switch straight to the target.
+ */
+struct ChainSmoother
 {
-    leftLowCut.template setBypassed<0>(true);
-    leftLowCut.template setBypassed<1>(true);
-    leftLowCut.template setBypassed<2>(true);
-    leftLowCut.template setBypassed<3>(true);
+    void prepare(double sampleRate, double rampLengthSeconds);
+    void setTargets(const ChainSettings& targets);
+    void snapToTargets();
+
+    bool isSmoothing() const;
+    std::array<bool, NumBands> getSmoothingBands() const;
 
-    switch (lowCutSlope)
+    /** moves every ramp on by 'numSamples' and returns where they ended up. */
+    const ChainSettings& advance(int numSamples);
+    const ChainSettings& getCurrentSettings() const { return current; }
+private:
+    using LogSmoothedValue = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>;
+    using LinearSmoothedValue = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>;
+
+    LogSmoothedValue lowCutFreq, lowCutQ, highCutFreq, highCutQ, peak1Freq, peak1Q, peak2Freq, peak2Q;
+    LinearSmoothedValue peak1GainDB, peak2GainDB;
+    ChainSettings current;
+};
+
+/**
+ where each band's sections live inside a FusedCascade.
+ */
+enum CascadeSections
+{
+    LowCutSections = 0,
+    Peak1Section = 4,
+    Peak2Section = 5,
+    HighCutSections = 6,
+    NumCascadeSections = 10
+};
+
+/**
+ one second order section in Transposed Direct Form II: coefficients plus its two state variables.
+ */
+template<typename SampleType>
+struct CascadeSection
+{
+    SampleType b0{ 1.f }, b1{ 0.f }, b2{ 0.f }, a1{ 0.f }, a2{ 0.f };
+    SampleType s1{ 0.f }, s2{ 0.f };
+
+    SampleType processSample(SampleType x) noexcept
     {
-    case Slope_48:
-        update<3>(leftLowCut, cutCoefficients);
-    case Slope_36:
-        update<2>(leftLowCut, cutCoefficients);
-    case Slope_24:
-        update<1>(leftLowCut, cutCoefficients);
-    case Slope_12:
-        update<0>(leftLowCut, cutCoefficients);
+        auto y = b0 * x + s1;
+        s1 = b1 * x - a1 * y + s2;
+        s2 = b2 * x - a2 * y;
+        return y;
     }
-}
+};
 
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+/**
+ a cascade with a fixed number of sections. the per-sample section loop is expanded at compile time,
+ so there is no stage count or bypass check left in the inner loop.
+ Cascade<1> to Cascade<4> are a single cut band at Slope_12 to Slope_48, larger counts cover several bands fused together.
+ */
+template<typename SampleType, int NumSections>
+struct Cascade
 {
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
-        sampleRate,
-        2 * (chainSettings.lowCutSlope + 1), chainSettings.lowCutQ);
-}
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+    static void process(SampleType* samples,
+                        size_t numSamples,
+                        CascadeSection<SampleType>* sections,
+                        const int* activeSections) noexcept
+    {
+        processImpl(samples, numSamples, sections, activeSections, std::make_index_sequence<NumSections>());
+    }
+private:
+    template<size_t... Stage>
+    static void processImpl(SampleType* samples,
+                            size_t numSamples,
+                            CascadeSection<SampleType>* sections,
+                            const int* activeSections,
+                            std::index_sequence<Stage...>) noexcept
+    {
+        //work on local copies so the state can stay in registers for the whole block
+        CascadeSection<SampleType> local[] = { sections[activeSections[Stage]]... };
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            auto x = samples[i];
+            ((x = local[Stage].processSample(x)), ...);
+            samples[i] = x;
+        }
+
+        ((sections[activeSections[Stage]].s1 = local[Stage].s1, sections[activeSections[Stage]].s2 = local[Stage].s2), ...);
+    }
+};
+
+template<typename SampleType>
+struct Cascade<SampleType, 0>
 {
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
-        sampleRate,
-        2 * (chainSettings.highCutSlope + 1), chainSettings.highCutQ);
+    static void process(SampleType*, size_t, CascadeSection<SampleType>*, const int*) noexcept {}
+};
+
+/**
+ every second order section of a chain, processed in a single pass.
+ each sample runs through all enabled sections before the next sample is read, so the block is only
+ walked once no matter how many sections are active. whenever a band's bypass or slope changes, the
+ enabled sections are packed into an active list and the matching Cascade<N> kernel is picked from a
+ dispatch table, so the per-block work never checks bypass flags.
+ */
+template<typename SampleType>
+struct FusedCascade
+{
+    void reset()
+    {
+        for (auto& section : sections)
+            section.s1 = section.s2 = SampleType(0.f);
+    }
+
+    void setSection(int index, const BiquadCoefficients& coefficients)
+    {
+        auto& section = sections[index];
+        section.b0 = SampleType(coefficients.b0);
+        section.b1 = SampleType(coefficients.b1);
+        section.b2 = SampleType(coefficients.b2);
+        section.a1 = SampleType(coefficients.a1);
+        section.a2 = SampleType(coefficients.a2);
+    }
+
+    void setSectionEnabled(int index, bool shouldBeEnabled)
+    {
+        if (enabled[index] == shouldBeEnabled)
+            return;
+
+        //a section coming back from bypass starts from silence rather than from stale state
+        if (shouldBeEnabled)
+            sections[index].s1 = sections[index].s2 = SampleType(0.f);
+
+        enabled[index] = shouldBeEnabled;
+        activeSectionsChanged = true;
+    }
+
+    void process(SampleType* samples, size_t numSamples)
+    {
+        if (activeSectionsChanged)
+            rebuildActiveSections();
+
+        processFunction(samples, numSamples, sections.data(), activeSections.data());
+    }
+private:
+    using ProcessFunction = void (*)(SampleType*, size_t, CascadeSection<SampleType>*, const int*) noexcept;
+
+    template<size_t... NumSections>
+    static constexpr std::array<ProcessFunction, sizeof...(NumSections)> makeProcessFunctions(std::index_sequence<NumSections...>)
+    {
+        return { &Cascade<SampleType, int(NumSections)>::process... };
+    }
+
+    static constexpr std::array<ProcessFunction, NumCascadeSections + 1> processFunctions
+        = makeProcessFunctions(std::make_index_sequence<NumCascadeSections + 1>());
+
+    std::array<CascadeSection<SampleType>, NumCascadeSections> sections;
+    std::array<bool, NumCascadeSections> enabled{};
+    std::array<int, NumCascadeSections> activeSections{};
+    ProcessFunction processFunction = processFunctions[0];
+    bool activeSectionsChanged = false;
+
+    void rebuildActiveSections()
+    {
+        int numActiveSections = 0;
+        for (int index = 0; index < NumCascadeSections; ++index)
+        {
+            if (enabled[index])
+                activeSections[numActiveSections++] = index;
+        }
+        processFunction = processFunctions[numActiveSections];
+        activeSectionsChanged = false;
+    }
+};
+
+/**
+ loads a cut band into its four cascade sections, enabling as many as the slope needs.
+ */
+template<typename CascadeType>
+void updateCutSections(CascadeType& cascade,
+    int firstSection,
+    const std::array<BiquadCoefficients, 4>& cutCoefficients,
+    Slope slope,
+    bool bypassed)
+{
+    for (int stage = 0; stage < 4; ++stage)
+    {
+        cascade.setSection(firstSection + stage, cutCoefficients[stage]);
+        cascade.setSectionEnabled(firstSection + stage, !bypassed && stage <= slope);
+    }
 }
+
+//one channel per lane, all lanes sharing the same coefficients
+using SIMDSample = juce::dsp::SIMDRegister<float>;
+
+/**
+ runs a single FusedCascade over up to SIMDSample::size() channels at once.
+ the channels are interleaved into the lanes of a preallocated block, filtered in one pass, and deinterleaved again.
+ */
+struct SIMDChainProcessor
+{
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void process(const juce::dsp::AudioBlock<float>& block);
+
+    FusedCascade<SIMDSample> cascade;
+private:
+    juce::HeapBlock<char> interleavedData;
+    juce::dsp::AudioBlock<SIMDSample> interleaved;
+
+    void processChunk(const juce::dsp::AudioBlock<float>& block);
+};
+
+/**
+ a small pool of pre-spawned threads that a realtime thread can hand independent tasks to.
+ run() never locks or allocates: the tasks are claimed from an atomic counter by the workers and the caller alike,
+ and the caller spins until every task has finished. idle workers spin for a little over a block period
+ so back to back callbacks find them awake, then park and poll for the next run() every parkedPollMs.
+ run() never wakes them, whatever a parked worker doesn't get to in time the caller runs itself.
+ */
+struct ChannelGroupWorkers
+{
+    using Task = void (*)(void* context, int taskIndex);
+
+    ~ChannelGroupWorkers() { stop(); }
+
+    /**
+     spawns the workers, replacing any running ones. not realtime safe.
+     an idle worker keeps polling for blockPeriodMs and a bit, so one that just finished a block is still awake for the next.
+     */
+    void start(int numWorkersToUse, double blockPeriodMs);
+    void stop();
+    int getNumWorkers() const { return int(workers.size()); }
+
+    /**
+     calls task(context, i) for every i in [0, numTasks) across the workers and the calling thread, and returns as soon as
+     all of them have finished. tasks no worker picked up in time are run by the calling thread.
+     */
+    void run(int numTasks, Task task, void* context);
+private:
+    struct Worker : juce::Thread
+    {
+        Worker(ChannelGroupWorkers& owner) :
+            juce::Thread("EQ Channel Worker"), owner(owner), seenGeneration(getGeneration(owner.claims.load())) {}
+        void run() override;
+
+        ChannelGroupWorkers& owner;
+        juce::uint32 seenGeneration;
+    };
+
+    double spinMilliseconds = 0.0;
+    static constexpr int parkedPollMs = 1;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    /**
+     the generation in the top 32 bits, then the number of tasks and the next unclaimed one, 16 bits each.
+     a task is claimed by bumping the whole word, so a worker still holding an old generation can't claim from a newer run.
+     */
+    std::atomic<juce::uint64> claims{ 0 };
+    std::atomic<int> numTasksFinished{ 0 };
+    Task task = nullptr;
+    void* context = nullptr;
+
+    static juce::uint32 getGeneration(juce::uint64 word) { return juce::uint32(word >> 32); }
+    void runTasks(juce::uint32 generationToRun);
+};
+
+/**
+ the chain for any number of channels. the channels are split into groups of SIMDSample::size(),
+ each run by its own SIMDChainProcessor, so 12 channels cost three vectorised passes rather than twelve scalar ones.
+ every channel is linked to the same coefficients: setSection and setSectionEnabled go to all groups,
+ and are remembered so groups created by a later prepare() start from the current settings.
+ */
+struct MultiChannelChain
+{
+    /** allocates one group per SIMDSample::size() channels of spec.numChannels. */
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void process(const juce::dsp::AudioBlock<float>& block);
+
+    void setSection(int index, const BiquadCoefficients& coefficients);
+    void setSectionEnabled(int index, bool shouldBeEnabled);
+    void reset();
+
+    /** takes over another chain's coefficients and filter state. both must have been prepared for the same channels. */
+    void copyStateFrom(const MultiChannelChain& other);
+
+    int getNumGroups() const { return int(groups.size()); }
+
+    /**
+     lets process() spread the groups over these workers, or back to serial processing with nullptr.
+     blocks with less than minParallelWork group-samples always run serially, as waking the workers would cost more than it saves.
+     */
+    void setWorkers(ChannelGroupWorkers* workersToUse) { workers = workersToUse; }
+    static constexpr size_t minParallelWork = 256;
+private:
+    std::vector<SIMDChainProcessor> groups;
+    ChannelGroupWorkers* workers = nullptr;
+    const juce::dsp::AudioBlock<float>* parallelBlock = nullptr;
+
+    void processGroup(const juce::dsp::AudioBlock<float>& block, size_t group);
+    static void processGroupTask(void* chain, int group);
+    std::array<BiquadCoefficients, NumCascadeSections> sectionCoefficients;
+    std::array<bool, NumCascadeSections> sectionEnabled{};
+};
+
+//==============================================================================
+/**
+ designs filter coefficients on a background thread.
+ it polls the band versions every pollIntervalMs, and whenever one moved it redesigns that band and publishes
+ a full ChainCoefficients snapshot, which the audio thread picks up without locking or allocating.
+ polling rather than being woken keeps parameterChanged, which hosts may call from the audio thread, free of locks.
+ */
+struct LinearPhaseDesigner;
+
+struct CoefficientDesigner : juce::Thread
+{
+    CoefficientDesigner(juce::AudioProcessorValueTreeState& apvts,
+                        const std::array<juce::Atomic<int>, NumBands>& bandVersions,
+                        LinearPhaseDesigner& linearPhaseDesigner);
+    ~CoefficientDesigner() override;
+
+    /** designs every band, and the linear phase kernel, for the new sample rate and publishes both before returning. */
+    void prepare(double sampleRate);
+
+    static constexpr int pollIntervalMs = 5;
+
+    /** audio thread only. returns the newest snapshot if one was published since the last call, otherwise nullptr. */
+    const ChainCoefficients* getNewCoefficients();
+
+    void run() override;
+private:
+    juce::AudioProcessorValueTreeState& apvts;
+    const std::array<juce::Atomic<int>, NumBands>& bandVersions;
+    //polled on this thread after the chain, so linear phase doesn't need a thread of its own
+    LinearPhaseDesigner& linearPhaseDesigner;
+
+    juce::CriticalSection designLock;
+    double sampleRate = 0.0;
+    std::array<int, NumBands> designedBandVersions{};
+    int designedOversamplingFactor = 1;
+    ChainCoefficients designed;
+    TripleBuffer<ChainCoefficients> snapshots;
+
+    void designChangedBands(bool designAll);
+};
+
+//==============================================================================
+/** the FIR lengths offered by the "Linear Phase" parameter, 0 when it is off. */
+int getLinearPhaseLength(float choice);
+static constexpr int maxLinearPhaseLength = 16384;
+
+/**
+ a linear phase FIR, already cut into the partitions PartitionedConvolver works with and transformed.
+ */
+struct LinearPhaseKernel
+{
+    int length = 0;
+    //length / partitionSize spectra of PartitionedConvolver::numBins bins each
+    std::vector<std::complex<float>> partitions;
+};
+
+/**
+ uniformly partitioned overlap-save convolution of every channel with the same LinearPhaseKernel.
+ the input is collected into partitions of partitionSize samples, each of which is transformed once, kept in a
+ frequency domain delay line and multiplied with the matching kernel partition, so the cost per sample is the same
+ for every kernel length. all state is allocated in prepare().
+ a new kernel of the same length is crossfaded in over one partition. the latency is length / 2 + partitionSize.
+ */
+struct PartitionedConvolver
+{
+    static constexpr int partitionOrder = 8;
+    static constexpr int partitionSize = 1 << partitionOrder;
+    static constexpr int numBins = partitionSize + 1;
+
+    void prepare(int numChannels, int maxKernelLength);
+
+    /** clears the state and starts from a pure delay of length / 2, until a kernel of this length arrives. */
+    void setLength(int newLength);
+    int getLength() const { return length; }
+    int getLatency() const { return length / 2 + partitionSize; }
+
+    /** audio thread. copies the kernel in and crossfades to it. kernels of another length are ignored. */
+    void setKernel(const LinearPhaseKernel& kernel);
+
+    /** true once the output comes entirely from a designed kernel, rather than from the delay setLength() starts with. */
+    bool isReady() const { return ready; }
+
+    void process(const juce::dsp::AudioBlock<float>& block);
+private:
+    juce::dsp::FFT fft{ partitionOrder + 1 };
+
+    int numChannels = 0;
+    int maxPartitions = 0;
+    int length = 0;
+    int numPartitions = 0;
+
+    //the kernel in use and the one being crossfaded to
+    std::array<std::vector<std::complex<float>>, 2> kernels;
+    int activeKernel = 0;
+    bool crossfading = false;
+    bool kernelLoaded = false, ready = false;
+
+    //every channel's last numPartitions input spectra, newest at delayLineIndex
+    std::vector<std::complex<float>> delayLines;
+    int delayLineIndex = 0;
+
+    //the previous and the current partition of every channel's input, and the output of the previous partition
+    juce::AudioBuffer<float> inputs, outputs;
+    int fifoPosition = 0;
+
+    std::vector<float> fftBuffer;
+    std::vector<std::complex<float>> accumulator;
+    std::vector<float> crossfadeBuffer;
+
+    void processPartition();
+    void convolve(const std::vector<std::complex<float>>& kernel, const std::complex<float>* delayLine, float* output);
+};
+
+/**
+ builds the linear phase kernel while the "Linear Phase" parameter is on. it has no thread of its own,
+ CoefficientDesigner calls it from its polling thread, and under its lock from prepare().
+ the FIR's magnitude is the chain's, evaluated with MagnitudeResponse at the bins of a length sized FFT and
+ designed at the same rate as the response curve, with zero phase. it is centred, windowed and partitioned here,
+ so the audio thread only has to copy it in.
+ */
+struct LinearPhaseDesigner
+{
+    LinearPhaseDesigner(juce::AudioProcessorValueTreeState& apvts,
+                        const std::array<juce::Atomic<int>, NumBands>& bandVersions);
+
+    /** designs the kernel for the new sample rate, if linear phase is on, and publishes it before returning. */
+    void prepare(double sampleRate);
+
+    /** redesigns the kernel if linear phase is on and a band version moved since the last design. */
+    void designChangedKernel() { designKernel(false); }
+
+    /** audio thread only. returns the newest kernel if one was published since the last call, otherwise nullptr. */
+    const LinearPhaseKernel* getNewKernel();
+private:
+    juce::AudioProcessorValueTreeState& apvts;
+    const std::array<juce::Atomic<int>, NumBands>& bandVersions;
+    std::atomic<float>* linearPhaseChoice = nullptr;
+
+    double sampleRate = 0.0;
+    std::array<int, NumBands> designedBandVersions{};
+
+    ChainCoefficients coefficients;
+    MagnitudeResponse magnitudeResponse;
+    double magnitudeResponseRate = 0.0;
+    std::vector<double> magnitudesDB;
+    std::unique_ptr<juce::dsp::FFT> impulseFFT;
+    std::vector<float> impulse;
+    juce::dsp::FFT partitionFFT{ PartitionedConvolver::partitionOrder + 1 };
+    std::vector<float> partitionBuffer;
+    TripleBuffer<LinearPhaseKernel> kernels;
+
+    void designKernel(bool designAnyway);
+};
+
 //==============================================================================
 /**
 */
-class EQAudioProcessor  : public juce::AudioProcessor
+class EQAudioProcessor  : public juce::AudioProcessor,
+                          private juce::AudioProcessorValueTreeState::Listener,
+                          private juce::Timer
 {
 public:
     //==============================================================================
@@ -263,13 +868,104 @@ public:
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts{ *this, nullptr, "Parameters", createParameterLayout() };
     using BlockType = juce::AudioBuffer<float>;
-    SingleChannelSampleFifo<BlockType> rightChannelFifo{ Channel::Right};
-    SingleChannelSampleFifo<BlockType> leftChannelFifo{ Channel::Left};
+
+    //how far the analyzer may fall behind the audio thread before samples are dropped
+    static constexpr double analyzerBufferSeconds = 0.5;
+
+    //the signal picked by the "Analyzer Source" parameter, and the right channel when it is Overlay
+    SingleChannelSampleFifo<BlockType> analyzerFifo, overlayFifo;
 private:
-    MonoChain leftChain, rightChain;
-    void updatePeakFilter(const ChainSettings& chainSettings);
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
-    void updateFilters();
+    std::atomic<float>* analyzerSource = nullptr;
+    std::atomic<float>* oversamplingChoice = nullptr;
+    std::atomic<float>* linearPhaseChoice = nullptr;
+    juce::AudioBuffer<float> analyzerTap;
+    void updateAnalyzerFifos(const juce::AudioBuffer<float>& buffer);
+
+    MultiChannelChain chain;
+    size_t preparedBlockSize = 0;
+
+    //when the oversampling factor changes, the old path runs on for one block with a copy of the chain and is faded out under the new one
+    MultiChannelChain fadeChain;
+    juce::AudioBuffer<float> fadeBuffer;
+
+    //with "Parallel Processing" on, layouts with more than one channel group spread them over a few workers.
+    //they only run while the parameter is on, and are started and stopped on the message thread with processing suspended
+    static constexpr int maxChannelWorkers = 3;
+    ChannelGroupWorkers channelWorkers;
+    std::atomic<float>* parallelProcessing = nullptr;
+    std::atomic<int> preparedNumWorkers{ 0 };
+    std::atomic<double> preparedBlockPeriodMs{ 0.0 };
+    bool isParallelProcessingOn() const { return parallelProcessing->load() > .5f; }
+    void updateChannelWorkers();
+
+    //bumped from parameterChanged whenever one of a band's parameters moves.
+    //the designer only redesigns the bands that moved, and the audio thread only applies those bands.
+    std::array<juce::Atomic<int>, NumBands> bandVersions;
+    std::array<int, NumBands> appliedBandVersions{};
+
+    //in linear phase mode the FIR replaces the chain and the oversampling around it
+    LinearPhaseDesigner linearPhaseDesigner{ apvts, bandVersions };
+
+    CoefficientDesigner designer{ apvts, bandVersions, linearPhaseDesigner };
+
+    //the convolver in use, and the one a new length warms up in. the old length, or the chain, keeps playing
+    //until the new length's first kernel does, then the two are crossfaded over a prepared block
+    std::array<PartitionedConvolver, 2> convolvers;
+    int activeConvolver = 0;
+    bool lengthChangePending = false;
+    juce::AudioBuffer<float> lengthChangeBuffer;
+    PartitionedConvolver& getConvolver() { return convolvers[size_t(activeConvolver)]; }
+    PartitionedConvolver& getPendingConvolver() { return convolvers[size_t(1 - activeConvolver)]; }
+    int getRequestedLinearPhaseLength() { return lengthChangePending ? getPendingConvolver().getLength() : getConvolver().getLength(); }
+
+    //the FIR's length plus its latency while linear phase is on, read by getTailLengthSeconds
+    std::atomic<int> tailSamples{ 0 };
+
+    //while a ramp is running, the moving bands are redesigned every 'smoothingInterval' samples
+    ChainSmoother smoother;
+    ChainCoefficients smoothedCoefficients;
+    //"Smoothing Time" is how long a change takes to ramp in, "Smoothing Interval" how many samples pass between updates while it does
+    std::atomic<float>* smoothingTime = nullptr;
+    std::atomic<float>* smoothingIntervalChoice = nullptr;
+    float preparedSmoothingTime = 0.f;
+    float getSmoothingSeconds() const { return smoothingTime->load() / 1000.f; }
+    int getSmoothingInterval() const;
+
+    //2x and 4x polyphase IIR half-band oversamplers, both built in prepareToPlay so switching never allocates
+    std::array<std::unique_ptr<juce::dsp::Oversampling<float>>, 2> oversamplers;
+    //the factor the chain currently runs at, which follows the designed coefficients
+    int activeOversamplingFactor = 1;
+    //the factor whose latency is reported. while the chain isn't oversampled, the dry path is delayed by the same amount
+    int latencyOversamplingFactor = 1;
+    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> latencyDelay;
+
+    juce::dsp::Oversampling<float>& getOversampler(int factor) { return *oversamplers[factor == 2 ? 0 : 1]; }
+    double getProcessingSampleRate() const { return getSampleRate() * activeOversamplingFactor; }
+    void setOversamplingLatency(int factor);
+    void setLinearPhaseLength(int length);
+    int getPathLatency();
+
+    //processBlock notices path changes and only publishes the new latency, a message thread timer tells the host
+    std::atomic<int> pendingLatency{ 0 };
+    void updateLatency();
+    void timerCallback() override;
+    void setActiveOversamplingFactor(int factor);
+
+    /** runs whichever path is active on the block, fading between the old and the new one while a switch is under way. */
+    void processPaths(juce::dsp::AudioBlock<float>& block, int fadingOutFactor);
+    void processLengthChange(juce::dsp::AudioBlock<float>& block, int fadingOutFactor);
+    void processIIR(juce::dsp::AudioBlock<float>& block, int fadingOutFactor);
+    void processChain(juce::dsp::AudioBlock<float>& block);
+    /** the IIR path at 'factor' times the host rate: 'pathChain' inside the oversampler, or followed by the latency delay at 1x. */
+    void processIIRPath(juce::dsp::AudioBlock<float>& block, int factor, MultiChannelChain& pathChain);
+    void processSmoothed(juce::dsp::AudioBlock<float>& block);
+
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void updatePeak1Filter(const ChainCoefficients& chainCoefficients);
+    void updatePeak2Filter(const ChainCoefficients& chainCoefficients);
+    void updateLowCutFilters(const ChainCoefficients& chainCoefficients);
+    void updateHighCutFilters(const ChainCoefficients& chainCoefficients);
+    void updateFilters(const ChainCoefficients& chainCoefficients, bool updateAll);
+    void updateFilters(const ChainCoefficients& chainCoefficients, const std::array<bool, NumBands>& bands);
 };
 